@@ -0,0 +1,208 @@
+/// @file async_preview.h
+/// @brief render previews in the background
+/// @author Jeff Perry <jeffsp@gmail.com>
+/// @version 1.0
+/// @date 2014-07-27
+
+#ifndef ASYNC_PREVIEW_H
+#define ASYNC_PREVIEW_H
+
+#include "preview.h"
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace image_tiler
+{
+
+/// @brief get the factor that shrinks an image to at most a given number of pixels
+size_t get_shrink_factor (const size_t rows, const size_t cols, const size_t pixels)
+{
+    size_t f = 1;
+    while (((rows + f - 1) / f) * ((cols + f - 1) / f) > pixels)
+        ++f;
+    return f;
+}
+
+/// @brief get the scale of the tiling in a coarse frame
+///
+/// @param scale the scale of the exact frame
+/// @param f the factor that the image was shrunk by
+/// @param pixels pixels in the shrunken image
+/// @param t the tile
+/// @param polygons about the most polygons that a coarse frame may have
+///
+/// Shrinking the tiling along with the image leaves it with as many polygons as the exact frame.  When there would be
+/// more than the limit, the coarse tiles are made larger, so the geometry of a coarse frame is bounded too.
+double get_coarse_scale (const double scale, const size_t f, const size_t pixels, const convex_uniform_tile &t, const size_t polygons)
+{
+    // each tile covers width * height * scale * scale pixels
+    const double min_scale = ::sqrt (static_cast<double> (pixels) * t.get_polygons ().size () / (t.get_width () * t.get_height () * polygons));
+    return std::max (scale / f, min_scale);
+}
+
+/// @brief a preview that is rendered by a worker thread
+///
+/// The caller requests parameters and polls for finished frames, so it never waits for a render.  Only the latest
+/// request is rendered: requests that arrive while the worker is busy replace each other, and the render in progress
+/// is abandoned at the next stage boundary.  Finished frames are double buffered, so handing a frame to the caller
+/// swaps buffers instead of copying pixels.
+///
+/// Large images are rendered progressively.  When a request needs work that grows with the number of polygons, like
+/// moving the tiling, it is first rendered from a shrunken copy of the image, with the geometry shrunk to match, and
+/// that frame is enlarged and handed out.  The exact frame follows.  The work of the first frame is bounded by the size
+/// of the shrunken copy, not by the size of the image: tiles that would be tiny in the shrunken copy are drawn larger,
+/// so that there are at most about one sixteenth as many polygons as pixels.  Requests that only recolor or
+/// recomposite the exact frame, like changing the transparency, are already fast, so they skip the coarse frame.
+template<typename I>
+class async_preview
+{
+    public:
+    /// @brief constructor
+    ///
+    /// @param original the image to tile, which must outlive the preview
+    /// @param tl the tiles
+    /// @param coarse_pixels images with more pixels than this get a coarse frame first, 0 means never
+    async_preview (const I &original, const tile_list &tl, const size_t coarse_pixels = 1 << 19)
+        : f (coarse_pixels == 0 ? 1 : get_shrink_factor (original.rows (), original.cols (), coarse_pixels)),
+        small (f == 1 ? I () : shrink (original, f)), tl (tl), coarse (small, tl), pv (original, tl),
+        generation (0), pending (false), ready (false), ready_generation (0), ready_exact (false), coarse_frames (0),
+        done (false),
+        worker ([this] () { run (); })
+    { }
+    ~async_preview ()
+    {
+        {
+            std::lock_guard<std::mutex> lock (m);
+            done = true;
+        }
+        cv.notify_all ();
+        worker.join ();
+    }
+    async_preview (const async_preview &) = delete;
+    async_preview &operator= (const async_preview &) = delete;
+    /// @brief render a frame with new parameters, cancelling any older request
+    ///
+    /// @return the generation of the request, which identifies the frame that it produces
+    size_t request (const preview_params &p)
+    {
+        std::lock_guard<std::mutex> lock (m);
+        params = p;
+        pending = true;
+        cv.notify_all ();
+        return ++generation;
+    }
+    /// @brief get the latest finished frame, if there is one that has not been taken yet
+    ///
+    /// @param img the frame, which is swapped with the finished frame
+    /// @param g the generation of the request that produced the frame
+    /// @param exact false if the frame was rendered from the shrunken image
+    ///
+    /// @return true if a frame was taken
+    bool get_frame (I &img, size_t &g, bool &exact)
+    {
+        std::lock_guard<std::mutex> lock (m);
+        if (!ready)
+            return false;
+        std::swap (img, front);
+        g = ready_generation;
+        exact = ready_exact;
+        ready = false;
+        return true;
+    }
+    bool get_frame (I &img, size_t &g)
+    {
+        bool exact;
+        return get_frame (img, g, exact);
+    }
+    /// @brief get the number of coarse frames that have been finished, whether or not they were taken
+    size_t get_coarse_frames ()
+    {
+        std::lock_guard<std::mutex> lock (m);
+        return coarse_frames;
+    }
+    private:
+    void run ()
+    {
+        for (;;)
+        {
+            preview_params p;
+            size_t g;
+            {
+                std::unique_lock<std::mutex> lock (m);
+                cv.wait (lock, [&] { return done || pending; });
+                if (done)
+                    return;
+                p = params;
+                g = generation;
+                pending = false;
+            }
+            // give up as soon as there is a newer request
+            auto cancelled = [&] () { std::lock_guard<std::mutex> lock (m); return done || generation != g; };
+            pv.set_params (p);
+            // recoloring and recompositing are fast enough without a coarse frame
+            if (f != 1 && pv.needs_geometry_work ())
+            {
+                // the same tiling, in the coordinates of the shrunken image, unless its tiles would be too small
+                preview_params q (p);
+                const size_t pixels = small.rows () * small.cols ();
+                q.scale = get_coarse_scale (p.scale, f, pixels, tl[p.tile_index], pixels / 16);
+                q.xoffset /= f;
+                q.yoffset /= f;
+                if (q.min_pixels != 0)
+                    q.min_pixels = std::max (size_t (1), q.min_pixels / (f * f));
+                coarse.set_params (q);
+                if (!coarse.render (cancelled))
+                    continue;
+                if (back.rows () != pv.get_original ().rows () || back.cols () != pv.get_original ().cols ())
+                    back = I (pv.get_original ().rows (), pv.get_original ().cols ());
+                enlarge (coarse.get_image (), f, back);
+                publish (g, false);
+            }
+            // the frame is composited straight into the back buffer
+            if (!pv.render (cancelled, back))
+                continue;
+            publish (g, true);
+        }
+    }
+    void publish (const size_t g, const bool exact)
+    {
+        std::lock_guard<std::mutex> lock (m);
+        std::swap (front, back);
+        ready = true;
+        ready_generation = g;
+        ready_exact = exact;
+        if (!exact)
+            ++coarse_frames;
+    }
+    /// @brief shrink factor of the coarse frames, 1 if there are none
+    const size_t f;
+    const I small;
+    const tile_list &tl;
+    // the previews are only used by the worker
+    preview<I> coarse;
+    preview<I> pv;
+    /// @brief the frame that the worker is filling
+    I back;
+    std::mutex m;
+    std::condition_variable cv;
+    // the members below are guarded by m
+    preview_params params;
+    size_t generation;
+    bool pending;
+    /// @brief the latest finished frame
+    I front;
+    bool ready;
+    size_t ready_generation;
+    bool ready_exact;
+    size_t coarse_frames;
+    bool done;
+    std::thread worker;
+};
+
+} // namespace image_tiler
+
+#endif // ASYNC_PREVIEW_H
@@ -0,0 +1,202 @@
+/// @file band_tiler.h
+/// @brief tile an image one horizontal band at a time
+/// @author Jeff Perry <jeffsp@gmail.com>
+/// @version 1.0
+/// @date 2014-07-27
+
+#ifndef BAND_TILER_H
+#define BAND_TILER_H
+
+#include "geometry.h"
+#include "graphics.h"
+#include "image.h"
+#include "polygon_soup.h"
+#include "tile_visitor.h"
+#include "tiles.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace image_tiler
+{
+
+/// @brief read bands from an image that is already in memory
+class image_band_reader
+{
+    public:
+    explicit image_band_reader (const rgb8_image_t &img)
+        : img (img), row (0)
+    { }
+    size_t rows () const { return img.rows (); }
+    size_t cols () const { return img.cols (); }
+    /// @brief read the next n rows into the top of a band
+    void read (rgb8_image_t &band, const size_t n)
+    {
+        assert (row + n <= img.rows ());
+        std::copy (img.begin () + img.index (row, 0, 0), img.begin () + img.index (row + n, 0, 0), band.begin ());
+        row += n;
+    }
+    private:
+    const rgb8_image_t &img;
+    size_t row;
+};
+
+/// @brief collect bands into an image that is in memory
+class image_band_writer
+{
+    public:
+    image_band_writer (rgb8_image_t &img)
+        : img (img), row (0)
+    { }
+    /// @brief write the top n rows of a band
+    void write (const rgb8_image_t &band, const size_t n)
+    {
+        assert (row + n <= img.rows ());
+        std::copy (band.begin (), band.begin () + band.index (n, 0, 0), img.begin () + img.index (row, 0, 0));
+        row += n;
+    }
+    private:
+    rgb8_image_t &img;
+    size_t row;
+};
+
+/// @brief tile an image one band at a time
+///
+/// @param src band source, with rows (), cols () and read (band, n)
+/// @param dst band sink, with write (band, n)
+/// @param t the tile
+/// @param scale scale of the tile
+/// @param angle angle of the tile
+/// @param band_rows rows in each band
+///
+/// @return the number of polygons
+///
+/// The polygons are generated from the top of the image to the bottom as the input bands are read, and each one is
+/// rasterized once, when the first band that it might touch is read.  Every polygon that touches an input band
+/// accumulates partial sums, and a polygon whose last row has been read gets its final color.  An output band is
+/// painted and written as soon as every polygon that touches it has its final color, and a polygon is dropped once its
+/// last row has been written.  Besides one heap entry per lattice row, only the polygons between the output band and
+/// the input band are stored, so peak memory grows with the band height and the image width, but not with the image
+/// height.  The output is identical to filling the clipped scanlines of the whole image.
+template<typename Source,typename Sink>
+size_t tile_bands (Source &src, Sink &dst, const convex_uniform_tile &t, const double scale, const double angle, const size_t band_rows)
+{
+    assert (band_rows != 0);
+    const size_t rows = src.rows ();
+    const size_t cols = src.cols ();
+    const rect window (0, 0, cols, rows);
+    window_polygon_sweep sweep (rows, cols, point (cols / 2.0, rows / 2.0), t, scale, angle);
+    // a polygon that has been rasterized, but whose last row has not been written
+    struct region
+    {
+        size_t index;
+        scanlines s;
+        // the next scanline to read and to write
+        uint32_t in;
+        uint32_t out;
+        uint64_t sums[3];
+        size_t count;
+        rgb8_pixel_t m;
+    };
+    // in painting order, so that the last polygon wins where they overlap
+    std::vector<region> active;
+    // the polygons that were generated for the current band, back to back
+    polygon_soup fresh;
+    size_t total = 0;
+    rgb8_image_t in (band_rows, cols);
+    rgb8_image_t out (band_rows, cols);
+    size_t out_y = 0;
+    for (size_t y0 = 0; y0 < rows; y0 += band_rows)
+    {
+        const size_t y1 = std::min (rows, y0 + band_rows);
+        src.read (in, y1 - y0);
+        // get the polygons that might start in this band
+        fresh.clear ();
+        sweep.visit (y1, [&] (const polygon &p) { fresh.push_back (p); });
+        total += fresh.size ();
+        const size_t n = active.size ();
+        active.resize (n + fresh.size ());
+#pragma omp parallel
+        {
+            scanlines s;
+#pragma omp for schedule (dynamic, 64)
+            for (size_t i = 0; i < fresh.size (); ++i)
+            {
+                region &a = active[n + i];
+                a.index = fresh[i].get_tile_index ();
+                s.clear ();
+                get_convex_polygon_scanlines (fresh[i], s);
+                clip (s, window, a.s);
+                a.in = 0;
+                a.out = 0;
+                std::fill (a.sums, a.sums + 3, 0);
+                a.count = 0;
+            }
+        }
+        // polygons that only graze the image are dropped
+        active.erase (std::remove_if (active.begin () + n, active.end (), [] (const region &a) { return a.s.empty (); }), active.end ());
+        if (active.size () != n)
+        {
+            const auto by_index = [] (const region &a, const region &b) { return a.index < b.index; };
+            std::sort (active.begin () + n, active.end (), by_index);
+            std::inplace_merge (active.begin (), active.begin () + n, active.end (), by_index);
+        }
+        // accumulate the part of each polygon that is in this band
+#pragma omp parallel for schedule (dynamic, 64)
+        for (size_t i = 0; i < active.size (); ++i)
+        {
+            region &a = active[i];
+            if (a.in == a.s.size ())
+                continue;
+            for (; a.in < a.s.size () && a.s[a.in].y < static_cast<int> (y1); ++a.in)
+            {
+                const scanline &j = a.s[a.in];
+                assert (j.y >= static_cast<int> (y0));
+                const unsigned char *q = &in (j.y - y0, j.x, 0);
+                for (unsigned x = 0; x < j.len; ++x, q += 3)
+                {
+                    a.sums[0] += q[0];
+                    a.sums[1] += q[1];
+                    a.sums[2] += q[2];
+                }
+                a.count += j.len;
+            }
+            // its last row has been read
+            if (a.in == a.s.size ())
+                for (size_t k = 0; k < 3; ++k)
+                    a.m[k] = ::round (static_cast<double> (a.sums[k]) / a.count);
+        }
+        // write output bands whose polygons are all final
+        while (out_y < y1)
+        {
+            const size_t o1 = std::min (rows, out_y + band_rows);
+            assert (o1 <= y1);
+            const bool ready = std::none_of (active.begin (), active.end (), [&] (const region &a)
+                { return a.in < a.s.size () && a.s[a.out].y < static_cast<int> (o1); });
+            if (!ready)
+                break;
+            out.assign (0);
+            for (auto &a : active)
+            {
+                if (a.out == a.s.size () || a.s[a.out].y >= static_cast<int> (o1))
+                    continue;
+                const unsigned char c[3] = { a.m[0], a.m[1], a.m[2] };
+                const pixel_pattern<3> f (c);
+                for (; a.out < a.s.size () && a.s[a.out].y < static_cast<int> (o1); ++a.out)
+                    f.fill (&out (a.s[a.out].y - out_y, a.s[a.out].x, 0), a.s[a.out].len);
+            }
+            dst.write (out, o1 - out_y);
+            out_y = o1;
+            // drop the polygons that have been written
+            active.erase (std::remove_if (active.begin (), active.end (), [] (const region &a) { return a.out == a.s.size (); }), active.end ());
+        }
+    }
+    assert (active.empty ());
+    return total;
+}
+
+} // namespace image_tiler
+
+#endif // BAND_TILER_H
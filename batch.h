@@ -0,0 +1,190 @@
+/// @file batch.h
+/// @brief lists of images to tile
+/// @author Jeff Perry <jeffsp@gmail.com>
+/// @version 1.0
+/// @date 2014-07-27
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "utils.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <dirent.h>
+#include <sys/stat.h>
+
+namespace image_tiler
+{
+
+/// @brief one input image and the file to write its tiled version to
+struct batch_job
+{
+    std::string input;
+    std::string output;
+};
+
+typedef std::vector<batch_job> batch_jobs;
+
+/// @brief get a filename without its directory or extension
+std::string get_stem (const std::string &fn)
+{
+    const size_t slash = fn.rfind ('/');
+    const std::string base = slash == std::string::npos ? fn : fn.substr (slash + 1);
+    const size_t dot = base.rfind ('.');
+    return dot == std::string::npos || dot == 0 ? base : base.substr (0, dot);
+}
+
+/// @brief get the output filename for an input
+///
+/// @param input the input filename
+/// @param output_dir the output directory
+/// @param ext the output extension, without the '.'
+std::string get_output_filename (const std::string &input, const std::string &output_dir, const std::string &ext)
+{
+    std::string fn = output_dir;
+    if (!fn.empty () && fn.back () != '/')
+        fn += '/';
+    return fn + get_stem (input) + "." + ext;
+}
+
+/// @brief check if a filename has the extension of an image that we can read
+bool is_image_filename (const std::string &fn)
+{
+    static const std::vector<std::string> exts { "bmp", "jpeg", "jpg", "pam", "png", "ppm", "rgb", "tif", "tiff" };
+    return std::find (exts.begin (), exts.end (), get_extension (fn)) != exts.end ();
+}
+
+/// @brief check if a path is a directory
+bool is_directory (const std::string &path)
+{
+    struct stat st;
+    return stat (path.c_str (), &st) == 0 && S_ISDIR (st.st_mode);
+}
+
+/// @brief create a directory and its parents, if they do not already exist
+void create_directory (const std::string &path)
+{
+    for (size_t n = path.find ('/', 1); ; n = path.find ('/', n + 1))
+    {
+        const std::string dir = path.substr (0, n);
+        if (!dir.empty () && !is_directory (dir) && mkdir (dir.c_str (), 0777) != 0 && !is_directory (dir))
+            throw std::runtime_error ("could not create directory " + dir);
+        if (n == std::string::npos)
+            break;
+    }
+}
+
+/// @brief make sure that no two jobs write to the same file
+///
+/// Inputs that only differ by their extension, like 'a.png' and 'a.jpg', would otherwise overwrite each other's output.
+void check_outputs (const batch_jobs &jobs)
+{
+    std::vector<const batch_job *> v;
+    for (const auto &j : jobs)
+        v.push_back (&j);
+    std::stable_sort (v.begin (), v.end (), [] (const batch_job *a, const batch_job *b) { return a->output < b->output; });
+    for (size_t i = 1; i < v.size (); ++i)
+        if (v[i - 1]->output == v[i]->output)
+            throw std::runtime_error ("'" + v[i - 1]->input + "' and '" + v[i]->input + "' would both be written to '" + v[i]->output + "'");
+}
+
+/// @brief create the directory of each job's output, so that no job fails after it has been tiled
+void create_output_directories (const batch_jobs &jobs)
+{
+    std::set<std::string> dirs;
+    for (const auto &j : jobs)
+    {
+        const size_t n = j.output.rfind ('/');
+        if (n != std::string::npos && n != 0)
+            dirs.insert (j.output.substr (0, n));
+    }
+    for (const auto &d : dirs)
+        create_directory (d);
+}
+
+/// @brief read a batch manifest
+///
+/// @param s the manifest
+/// @param output_dir where to write outputs that are not named in the manifest
+/// @param ext the extension of outputs that are not named in the manifest
+///
+/// @return the jobs
+///
+/// Each line holds an input filename, optionally followed by an output filename.  Blank lines and lines that start
+/// with '#' are ignored.  Filenames may not contain whitespace.
+batch_jobs read_manifest (std::istream &s, const std::string &output_dir, const std::string &ext)
+{
+    batch_jobs jobs;
+    std::string line;
+    while (std::getline (s, line))
+    {
+        std::stringstream ss (line);
+        batch_job j;
+        if (!(ss >> j.input) || j.input[0] == '#')
+            continue;
+        if (!(ss >> j.output))
+            j.output = get_output_filename (j.input, output_dir, ext);
+        jobs.push_back (j);
+    }
+    return jobs;
+}
+
+/// @brief get a job for each image in a directory
+///
+/// @param dir the directory
+/// @param output_dir where to write outputs
+/// @param ext the extension of the outputs
+///
+/// @return the jobs, sorted by input filename
+batch_jobs get_directory_jobs (const std::string &dir, const std::string &output_dir, const std::string &ext)
+{
+    DIR *d = opendir (dir.c_str ());
+    if (d == nullptr)
+        throw std::runtime_error ("could not open directory");
+    std::vector<std::string> fns;
+    while (const dirent *e = readdir (d))
+    {
+        const std::string fn = dir + "/" + e->d_name;
+        if (is_image_filename (fn) && !is_directory (fn))
+            fns.push_back (fn);
+    }
+    closedir (d);
+    std::sort (fns.begin (), fns.end ());
+    batch_jobs jobs;
+    for (const auto &fn : fns)
+        jobs.push_back (batch_job { fn, get_output_filename (fn, output_dir, ext) });
+    return jobs;
+}
+
+/// @brief get the jobs listed in a manifest, or one for each image in a directory
+///
+/// Throws if two jobs would write to the same file.  The directories of all of the outputs, including the ones named
+/// in a manifest, are created.
+batch_jobs get_batch_jobs (const std::string &path, const std::string &output_dir, const std::string &ext)
+{
+    batch_jobs jobs;
+    if (is_directory (path))
+    {
+        jobs = get_directory_jobs (path, output_dir, ext);
+    }
+    else
+    {
+        std::ifstream ifs (path.c_str ());
+        if (!ifs)
+            throw std::runtime_error ("could not open manifest for reading");
+        jobs = read_manifest (ifs, output_dir, ext);
+    }
+    check_outputs (jobs);
+    create_output_directories (jobs);
+    return jobs;
+}
+
+} // namespace image_tiler
+
+#endif // BATCH_H
@@ -0,0 +1,659 @@
+/// @file coverage.h
+/// @brief anti-aliased rasterization, from the exact area of each pixel that a polygon covers
+/// @author Jeff Perry <jeffsp@gmail.com>
+/// @version 1.0
+/// @date 2014-07-27
+
+#ifndef COVERAGE_H
+#define COVERAGE_H
+
+#include "geometry.h"
+#include "graphics.h"
+#include "image.h"
+#include "polygon_soup.h"
+#include "stats.h"
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace image_tiler
+{
+
+/// @brief a pixel on the edge of a polygon
+struct edge_pixel
+{
+    edge_pixel (int y = 0, int x = 0, float a = 0.0f)
+        : y (y), x (x), a (a)
+    {
+    }
+    int y;
+    int x;
+    /// @brief the fraction of the pixel's area that the polygon covers
+    float a;
+};
+
+/// @brief the pixels that a polygon covers
+///
+/// Pixels that are entirely inside the polygon are stored as scanlines, and only the pixels on its edges carry a
+/// coverage value.  Both are in ascending row order.
+struct coverage
+{
+    /// @brief pixels that the polygon covers entirely
+    scanlines full;
+    /// @brief pixels that the polygon covers partly
+    std::vector<edge_pixel> edges;
+
+    bool empty () const { return full.empty () && edges.empty (); }
+    void clear ()
+    {
+        full.clear ();
+        edges.clear ();
+    }
+};
+
+/// @brief the coverage of many polygons
+typedef std::vector<coverage> polygon_coverage;
+
+/// @brief clip a convex polygon to one side of a horizontal or vertical line
+///
+/// @param p the polygon
+/// @param c the coordinate that is tested, &point::x or &point::y
+/// @param v the line
+/// @param above keep the side where the coordinate is at least v, instead of the side where it is at most v
+/// @param q the clipped polygon
+///
+/// Points on the line are given the exact coordinate v, so the edges of the clipped polygon can be found by comparing
+/// coordinates.
+void clip_polygon (const std::vector<point> &p, double point::*c, const double v, const bool above, std::vector<point> &q)
+{
+    q.clear ();
+    const size_t n = p.size ();
+    for (size_t i = 0; i < n; ++i)
+    {
+        const point &a = p[i];
+        const point &b = p[(i + 1) % n];
+        const double da = above ? v - a.*c : a.*c - v;
+        const double db = above ? v - b.*c : b.*c - v;
+        if (da <= 0.0)
+            q.push_back (a);
+        if ((da < 0.0 && db > 0.0) || (da > 0.0 && db < 0.0))
+        {
+            const double t = da / (da - db);
+            point r (a.x + t * (b.x - a.x), a.y + t * (b.y - a.y));
+            r.*c = v;
+            q.push_back (r);
+        }
+    }
+}
+
+/// @brief get the area of a polygon
+double get_area (const std::vector<point> &p)
+{
+    double a = 0.0;
+    for (size_t i = 0, j = p.size () - 1; i < p.size (); j = i++)
+        a += (p[j].x + p[i].x) * (p[j].y - p[i].y);
+    return std::abs (a) / 2.0;
+}
+
+/// @brief get the area of the part of a convex polygon that is left of a vertical line
+///
+/// @param p the polygon
+/// @param v the line
+///
+/// This is the area of the polygon that clip_polygon () returns, but the clipped edges are summed as they are found,
+/// instead of being stored.  The parts of the line that join them add nothing, except for the one that closes the
+/// boundary, because the polygon is convex.
+double get_left_area (const std::vector<point> &p, const double v)
+{
+    const size_t n = p.size ();
+    double a = 0.0;
+    bool found = false;
+    point first;
+    point last;
+    for (size_t i = 0; i < n; ++i)
+    {
+        point c = p[i];
+        point d = p[(i + 1) % n];
+        if (c.x > v && d.x > v)
+            continue;
+        if (c.x > v)
+            c = point (v, c.y + (v - c.x) / (d.x - c.x) * (d.y - c.y));
+        else if (d.x > v)
+            d = point (v, c.y + (v - c.x) / (d.x - c.x) * (d.y - c.y));
+        if (found)
+            a += last.x * c.y - c.x * last.y;
+        else
+            first = c;
+        a += c.x * d.y - d.x * c.y;
+        last = d;
+        found = true;
+    }
+    if (found)
+        a += last.x * first.y - first.x * last.y;
+    return std::abs (a) / 2.0;
+}
+
+/// @brief get the coverage of a convex polygon
+///
+/// @param p the polygon
+/// @param window only pixels inside this rectangle are returned
+/// @param c pixels are appended to this container
+///
+/// Pixel (x, y) is the square [x, x + 1) x [y, y + 1).  The polygon is clipped to each row, and the pixels of the row
+/// that are entirely inside the clipped polygon are found from its top and bottom edges.  Only the pixels on either
+/// side of them are measured, so the work is proportional to the perimeter of the polygon, not to its
+/// area.  The coverage of the pixels of a polygon sums to the area of the part of the polygon that is in the window,
+/// and the polygons of a tiling cover each pixel once.
+template<typename P>
+void get_convex_polygon_coverage (const P &p, const rect &window, coverage &c)
+{
+    if (p.size () < 3)
+        return;
+    std::vector<point> v (p.begin (), p.end ());
+    double minx = v[0].x;
+    double maxx = v[0].x;
+    double miny = v[0].y;
+    double maxy = v[0].y;
+    for (const auto &i : v)
+    {
+        minx = std::min (minx, i.x);
+        maxx = std::max (maxx, i.x);
+        miny = std::min (miny, i.y);
+        maxy = std::max (maxy, i.y);
+    }
+    const int wx1 = window.x;
+    const int wx2 = window.x + static_cast<int> (window.width);
+    const int y1 = std::max (static_cast<int> (::floor (miny)), window.y);
+    const int y2 = std::min (static_cast<int> (::ceil (maxy)), window.y + static_cast<int> (window.height));
+    // coverage that is smaller than this is rounding error
+    const double eps = 1e-6;
+    std::vector<point> a;
+    std::vector<point> s;
+    a.reserve (v.size () + 2);
+    s.reserve (v.size () + 4);
+    // a convex polygon's boundary crosses at most this many pixels
+    c.edges.reserve (c.edges.size () + 2 * (::ceil (maxx - minx) + ::ceil (maxy - miny)) + 4);
+    // measure the pixels of row y from x1 up to x2 that are in the window
+    auto add_edges = [&] (const int y, int x1, int x2)
+    {
+        x1 = std::max (x1, wx1);
+        x2 = std::min (x2, wx2);
+        if (x1 >= x2)
+            return;
+        double a1 = get_left_area (s, x1);
+        for (int x = x1; x < x2; ++x)
+        {
+            const double a2 = get_left_area (s, x + 1);
+            if (a2 - a1 > eps)
+                c.edges.push_back (edge_pixel (y, x, std::min (a2 - a1, 1.0)));
+            a1 = a2;
+        }
+    };
+    for (int y = y1; y < y2; ++y)
+    {
+        clip_polygon (v, &point::y, y, true, a);
+        clip_polygon (a, &point::y, y + 1, false, s);
+        if (s.size () < 3)
+            continue;
+        double left = s[0].x;
+        double right = s[0].x;
+        // the extents of the top and bottom edges of the clipped polygon
+        double t1 = std::numeric_limits<double>::max ();
+        double t2 = std::numeric_limits<double>::lowest ();
+        double b1 = t1;
+        double b2 = t2;
+        for (const auto &i : s)
+        {
+            left = std::min (left, i.x);
+            right = std::max (right, i.x);
+            if (i.y == y)
+            {
+                t1 = std::min (t1, i.x);
+                t2 = std::max (t2, i.x);
+            }
+            if (i.y == y + 1)
+            {
+                b1 = std::min (b1, i.x);
+                b2 = std::max (b2, i.x);
+            }
+        }
+        const int sx1 = ::floor (left);
+        const int sx2 = ::ceil (right);
+        // the pixels that are entirely covered, if the polygon spans the whole row
+        int f1 = sx2;
+        int f2 = sx2;
+        if (miny <= y && maxy >= y + 1 && t1 <= t2 && b1 <= b2)
+        {
+            // the sides of a convex polygon are convex, so they are innermost at the top or bottom of the row
+            f1 = ::ceil (std::max (t1, b1));
+            f2 = ::floor (std::min (t2, b2));
+            if (f2 <= f1)
+                f1 = f2 = sx2;
+        }
+        add_edges (y, sx1, f1);
+        const int x1 = std::max (f1, wx1);
+        const int x2 = std::min (f2, wx2);
+        if (x1 < x2)
+            c.full.push_back (scanline (y, x1, x2 - x1));
+        add_edges (y, f2, sx2);
+    }
+}
+
+/// @brief get polygons that cover part of a window
+///
+/// @param w width of window
+/// @param h height of window
+/// @param p polygons
+///
+/// @return covering polygons
+///
+/// get_intersecting_polygons () rounds the bounding rectangles to whole pixels, so it can drop polygons that only
+/// cover slivers of the pixels on the border of the window.  Here, the exact bounding rectangles are compared.
+polygon_soup get_covering_polygons (const unsigned w, const unsigned h, const polygon_soup &p)
+{
+    std::vector<uint32_t> keep;
+    size_t n = 0;
+    for (size_t i = 0; i < p.size (); ++i)
+    {
+        const rectf &r = p[i].get_bounds ();
+        if (r.maxx > 0.0 && r.minx < w && r.maxy > 0.0 && r.miny < h)
+        {
+            keep.push_back (i);
+            n += p[i].size ();
+        }
+    }
+    polygon_soup l;
+    l.reserve (keep.size (), n);
+    for (auto i : keep)
+        l.push_back (p[i]);
+    return l;
+}
+
+/// @brief get the coverage of convex polygons
+///
+/// @param rows rows in window
+/// @param cols cols in window
+/// @param p the polygons
+///
+/// @return the coverage of each polygon, inside the window
+template<typename PS>
+polygon_coverage get_polygon_coverage (const size_t rows, const size_t cols, const PS &p)
+{
+    const rect window (0, 0, cols, rows);
+    polygon_coverage c (p.size ());
+    // each polygon is independent, so the result does not depend on the number of threads
+#pragma omp parallel for schedule (dynamic, 256)
+    for (size_t i = 0; i < p.size (); ++i)
+        get_convex_polygon_coverage (p[i], window, c[i]);
+    return c;
+}
+
+/// @brief get the coverage weighted mean of a region
+///
+/// @param img the image
+/// @param c the pixels that cover the region
+///
+/// @return the region statistics, of which only the mean and count are set
+///
+/// Each pixel is weighted by the fraction of it that the region covers, so regions that are smaller than a pixel, and
+/// that have no scanlines, still get the color of the pixels they are in.  The count is the number of pixels that the
+/// region touches.  Without edge pixels, the result is identical to get_region_stats (img, c.full).
+template<typename T,size_t CHANNELS,typename Cont,typename Order>
+region_stats<CHANNELS> get_region_stats (const image<T,CHANNELS,Cont,Order> &img, const coverage &c)
+{
+    region_stats<CHANNELS> r;
+    std::array<uint64_t,CHANNELS> sum;
+    sum.fill (0);
+    for (const auto &i : c.full)
+    {
+        const T *p = &img[img.index (i.y, i.x, 0) - Order::channel (0)];
+        for (unsigned x = 0; x < i.len; ++x, p += CHANNELS)
+            for (size_t k = 0; k < CHANNELS; ++k)
+                sum[k] += p[k];
+        r.count += i.len;
+    }
+    std::array<double,CHANNELS> partial;
+    partial.fill (0.0);
+    double weight = 0.0;
+    for (const auto &i : c.edges)
+    {
+        const T *p = &img[img.index (i.y, i.x, 0) - Order::channel (0)];
+        for (size_t k = 0; k < CHANNELS; ++k)
+            partial[k] += i.a * p[k];
+        weight += i.a;
+    }
+    const double total = r.count + weight;
+    r.count += c.edges.size ();
+    if (total == 0.0)
+        return r;
+    for (size_t k = 0; k < CHANNELS; ++k)
+    {
+        // sums are in storage order
+        const size_t j = Order::channel (k);
+        r.mean[k] = ::round ((sum[j] + partial[j]) / total);
+    }
+    return r;
+}
+
+/// @brief get the coverage weighted means of many regions
+template<typename T,size_t CHANNELS,typename Cont,typename Order>
+std::vector<region_stats<CHANNELS>> get_region_stats (const image<T,CHANNELS,Cont,Order> &img, const polygon_coverage &c)
+{
+    std::vector<region_stats<CHANNELS>> r (c.size ());
+#pragma omp parallel for schedule (dynamic, 256)
+    for (size_t i = 0; i < c.size (); ++i)
+        r[i] = get_region_stats (img, c[i]);
+    return r;
+}
+
+/// @brief blends the edge pixels of one row at a time
+///
+/// The regions that cover a pixel completely are given first, in region order, so that the last one wins.  Then the
+/// edge coverage is added from the last region to the first, and each one gets as much of the pixel's coverage as is
+/// left over by the regions after it.  Whatever is left after that comes from the last region that covers the whole
+/// pixel, if there is one.  The buffers are reused from row to row, and only the pixels that were touched are cleared.
+template<size_t CHANNELS>
+class edge_blender
+{
+    public:
+    explicit edge_blender (const size_t cols)
+        : sum (cols * CHANNELS)
+        , covered (cols)
+        , owner (cols, none)
+        , touched (cols)
+    {
+    }
+    /// @brief a region covers a whole pixel
+    void cover (const uint32_t x, const uint32_t i)
+    {
+        owner[x] = i;
+    }
+    /// @brief add the part of a pixel that a region covers
+    template<typename P>
+    void add (const uint32_t x, const uint32_t i, const float a, const std::vector<P> &m)
+    {
+        if (!touched[x])
+        {
+            touched[x] = 1;
+            xs.push_back (x);
+        }
+        if (owner[x] != none && owner[x] > i)
+            return;
+        const float b = std::min (a, 1.0f - covered[x]);
+        if (b <= 0.0f)
+            return;
+        for (size_t k = 0; k < CHANNELS; ++k)
+            sum[x * CHANNELS + k] += b * m[i][k];
+        covered[x] += b;
+    }
+    /// @brief round each blended pixel once, and get ready for the next row
+    ///
+    /// @param m the colors of the regions
+    /// @param f functor that is called with the column, the channel and the value of each blended pixel
+    template<typename P,typename F>
+    void finish (const std::vector<P> &m, F f)
+    {
+        for (auto x : xs)
+        {
+            const float rest = owner[x] == none ? 0.0f : 1.0f - covered[x];
+            for (size_t k = 0; k < CHANNELS; ++k)
+            {
+                float &v = sum[x * CHANNELS + k];
+                if (rest > 0.0f)
+                    v += rest * m[owner[x]][k];
+                f (x, k, static_cast<unsigned char> (std::min (255, static_cast<int> (::round (v)))));
+                v = 0.0f;
+            }
+            covered[x] = 0.0f;
+            owner[x] = none;
+            touched[x] = 0;
+        }
+        xs.clear ();
+    }
+    private:
+    enum : uint32_t { none = ~0u };
+    std::vector<float> sum;
+    std::vector<float> covered;
+    std::vector<uint32_t> owner;
+    std::vector<unsigned char> touched;
+    std::vector<uint32_t> xs;
+};
+
+/// @brief visit the marked pixels of a run
+///
+/// @param marks one bit per pixel
+/// @param begin the first bit of the run
+/// @param end one past the last bit of the run
+/// @param f functor that is called with the offset of each marked pixel from the start of the run
+template<typename F>
+void visit_marks (const std::vector<uint64_t> &marks, const size_t begin, const size_t end, F f)
+{
+    for (size_t n = begin; n < end; n = (n / 64 + 1) * 64)
+    {
+        // the bits of this word that are in the run
+        uint64_t w = marks[n / 64] >> (n % 64);
+        if (end - n < 64)
+            w &= (uint64_t (1) << (end - n)) - 1;
+        for (; w != 0; w &= w - 1)
+            f (n - begin + __builtin_ctzll (w));
+    }
+}
+
+/// @brief paint anti-aliased regions, each with its own color
+///
+/// @param img the image, which must start out black
+/// @param c the coverage of each region
+/// @param m one color for each region
+///
+/// Whole pixels are filled with the color of their region, and later regions are painted over earlier ones, the same
+/// as fill () does with scanlines.  Edge pixels follow the same order, see edge_blender.  Where regions do not overlap,
+/// this is the coverage weighted mean of the colors of the regions that share a pixel.  The edges are sorted into
+/// rows, and summed a row at a time, so that each pixel is only rounded once.  Edge pixels are marked in a bitmap, so
+/// the rare whole pixels that land on them are found while the whole pixels are being painted.
+template<size_t CHANNELS,typename Cont,typename Order,typename P>
+void fill (image<unsigned char,CHANNELS,Cont,Order> &img, const polygon_coverage &c, const std::vector<P> &m)
+{
+    typedef image<unsigned char,CHANNELS,Cont,Order> image_type;
+    assert (c.size () == m.size ());
+    const size_t cols = img.cols ();
+    // mark the edge pixels, so that whole pixels that land on them, which only happens where regions overlap, are found
+    std::vector<uint64_t> is_edge ((img.rows () * cols + 63) / 64);
+    for (const auto &i : c)
+    {
+        for (const auto &j : i.edges)
+        {
+            const size_t n = j.y * cols + j.x;
+            is_edge[n / 64] |= uint64_t (1) << (n % 64);
+        }
+    }
+    struct cover
+    {
+        uint32_t y;
+        uint32_t x;
+        uint32_t i;
+    };
+    std::vector<cover> covers;
+    for (size_t i = 0; i < c.size (); ++i)
+    {
+        const span_filler<image_type> f (img, m[i]);
+        for (const auto &j : c[i].full)
+        {
+            f.fill (img, j);
+            const size_t begin = j.y * cols + j.x;
+            visit_marks (is_edge, begin, begin + j.len, [&] (const size_t x)
+                { covers.push_back (cover { uint32_t (j.y), uint32_t (j.x + x), uint32_t (i) }); });
+        }
+    }
+    // bucket the edges by row, in region order
+    struct contribution
+    {
+        uint32_t x;
+        uint32_t i;
+        float a;
+    };
+    std::vector<size_t> offsets (img.rows () + 1);
+    for (const auto &i : c)
+        for (const auto &j : i.edges)
+            ++offsets[j.y + 1];
+    for (size_t y = 0; y < img.rows (); ++y)
+        offsets[y + 1] += offsets[y];
+    std::vector<contribution> e (offsets.back ());
+    std::vector<size_t> next (offsets.begin (), offsets.end () - 1);
+    for (size_t i = 0; i < c.size (); ++i)
+    {
+        for (const auto &j : c[i].edges)
+        {
+            contribution &d = e[next[j.y]++];
+            d.x = j.x;
+            d.i = i;
+            d.a = j.a;
+        }
+    }
+    std::stable_sort (covers.begin (), covers.end (), [] (const cover &a, const cover &b) { return a.y < b.y; });
+#pragma omp parallel
+    {
+        edge_blender<CHANNELS> b (cols);
+#pragma omp for schedule (dynamic, 16)
+        for (size_t y = 0; y < img.rows (); ++y)
+        {
+            if (offsets[y] == offsets[y + 1])
+                continue;
+            const auto k1 = std::lower_bound (covers.begin (), covers.end (), y, [] (const cover &a, size_t y) { return a.y < y; });
+            for (auto k = k1; k != covers.end () && k->y == y; ++k)
+                b.cover (k->x, k->i);
+            for (size_t j = offsets[y + 1]; j-- > offsets[y]; )
+                b.add (e[j].x, e[j].i, e[j].a, m);
+            b.finish (m, [&] (const size_t x, const size_t k, const unsigned char v) { img (y, x, k) = v; });
+        }
+    }
+}
+
+/// @brief paint the rows of anti-aliased regions one at a time, without an image
+///
+/// Each row is the same as the corresponding row of an image that fill () painted.  The regions are visited in the
+/// order that they start, and each one keeps a cursor into its whole pixels and one into its edges, so only the edges
+/// of the current row are marked and blended.  The rows must be painted from top to bottom.
+template<typename P>
+class coverage_row_painter
+{
+    public:
+    /// @brief constructor
+    ///
+    /// @param cols cols in each row
+    /// @param c the coverage of each region
+    /// @param m one color for each region
+    coverage_row_painter (const size_t cols, const polygon_coverage &c, const std::vector<P> &m)
+        : cols (cols)
+        , c (c)
+        , m (m)
+        , y (0)
+        , is_edge ((cols + 63) / 64)
+        , b (cols)
+    {
+        assert (c.size () == m.size ());
+        // sort the regions by their first row with a counting sort, which keeps each row's regions in painting order
+        std::vector<int> first_rows (c.size (), -1);
+        for (size_t i = 0; i < c.size (); ++i)
+        {
+            if (c[i].empty ())
+                continue;
+            first_rows[i] = get_first_row (c[i]);
+            if (starts.size () < first_rows[i] + 2u)
+                starts.resize (first_rows[i] + 2);
+            ++starts[first_rows[i] + 1];
+        }
+        for (size_t y = 1; y < starts.size (); ++y)
+            starts[y] += starts[y - 1];
+        order.resize (starts.empty () ? 0 : starts.back ());
+        std::vector<size_t> next (starts);
+        for (size_t i = 0; i < c.size (); ++i)
+            if (first_rows[i] >= 0)
+                order[next[first_rows[i]]++] = i;
+    }
+    /// @brief paint the next row
+    ///
+    /// @param dst cols interlaced RGB pixels
+    void paint (unsigned char *dst)
+    {
+        std::memset (dst, 0, cols * 3);
+        // add the regions that start on this row, which are already in painting order, and merge them into the others
+        const size_t n = active.size ();
+        if (y + 1 < starts.size ())
+            for (size_t i = starts[y]; i < starts[y + 1]; ++i)
+                active.push_back (cursor { order[i], 0, 0 });
+        if (active.size () != n)
+            std::inplace_merge (active.begin (), active.begin () + n, active.end (), [] (const cursor &a, const cursor &b) { return a.i < b.i; });
+        // mark the edge pixels of this row
+        for (auto &a : active)
+        {
+            const std::vector<edge_pixel> &e = c[a.i].edges;
+            for (; a.edge < e.size () && e[a.edge].y == static_cast<int> (y); ++a.edge)
+                is_edge[e[a.edge].x / 64] |= uint64_t (1) << (e[a.edge].x % 64);
+        }
+        // paint the whole pixels, and note the ones that land on edge pixels
+        for (auto &a : active)
+        {
+            const scanlines &s = c[a.i].full;
+            if (a.full == s.size () || s[a.full].y != static_cast<int> (y))
+                continue;
+            const unsigned char q[3] = { m[a.i][0], m[a.i][1], m[a.i][2] };
+            const pixel_pattern<3> f (q);
+            for (; a.full < s.size () && s[a.full].y == static_cast<int> (y); ++a.full)
+            {
+                const scanline &j = s[a.full];
+                f.fill (dst + j.x * 3, j.len);
+                visit_marks (is_edge, j.x, j.x + j.len, [&] (const size_t x) { b.cover (j.x + x, a.i); });
+            }
+        }
+        // blend the edge pixels, latest region first, and clear their marks
+        for (size_t i = active.size (); i-- > 0; )
+        {
+            const cursor &a = active[i];
+            const std::vector<edge_pixel> &e = c[a.i].edges;
+            for (size_t j = a.edge; j-- > 0 && e[j].y == static_cast<int> (y); )
+            {
+                b.add (e[j].x, a.i, e[j].a, m);
+                is_edge[e[j].x / 64] = 0;
+            }
+        }
+        b.finish (m, [&] (const size_t x, const size_t k, const unsigned char v) { dst[x * 3 + k] = v; });
+        // keep the regions that have more rows
+        active.erase (std::remove_if (active.begin (), active.end (), [&] (const cursor &a)
+            { return a.full == c[a.i].full.size () && a.edge == c[a.i].edges.size (); }), active.end ());
+        ++y;
+    }
+    private:
+    static int get_first_row (const coverage &r)
+    {
+        if (r.full.empty ())
+            return r.edges[0].y;
+        if (r.edges.empty ())
+            return r.full[0].y;
+        return std::min (r.full[0].y, r.edges[0].y);
+    }
+    struct cursor
+    {
+        uint32_t i;
+        uint32_t full;
+        uint32_t edge;
+    };
+    const size_t cols;
+    const polygon_coverage &c;
+    const std::vector<P> &m;
+    // the regions, sorted by their first row, and where each row's regions start
+    std::vector<uint32_t> order;
+    std::vector<size_t> starts;
+    size_t y;
+    std::vector<cursor> active;
+    std::vector<uint64_t> is_edge;
+    edge_blender<3> b;
+};
+
+} // namespace image_tiler
+
+#endif // COVERAGE_H
@@ -10,8 +10,12 @@
 #include "image.h"
 #include "geometry.h"
 #include "utils.h"
-#include <iostream>
+#include <algorithm>
+#include <array>
+#include <cstdint>
 #include <cstring>
+#include <iostream>
+#include <limits>
 
 namespace image_tiler
 {
@@ -59,12 +63,16 @@ bool intersects (const rect &a, const rect &b)
     return ax1 < bx2 && ax2 > bx1 && ay1 < by2 && ay2 > by1;
 }
 
-rect get_bounding_rect (const polygon &p)
+rect get_bounding_rect (const rectf &r)
 {
-    rectf r = get_bounding_rectf (p);
     return rect (::round (r.minx), ::round (r.miny), ::round (r.maxx) - ::round (r.minx), ::round (r.maxy) - ::round (r.miny));
 }
 
+rect get_bounding_rect (const polygon &p)
+{
+    return get_bounding_rect (get_bounding_rectf (p));
+}
+
 bool is_close (const polygon &a, const polygon &b)
 {
     const rect ra = get_bounding_rect (a);
@@ -86,6 +94,10 @@ struct scanline
    int y;
    int x;
    unsigned len;
+   friend bool operator== (const scanline &a, const scanline &b)
+   {
+       return a.y == b.y && a.x == b.x && a.len == b.len;
+   }
 };
 
 typedef std::vector<scanline> scanlines;
@@ -150,29 +162,146 @@ scanlines get_intersecting_scanlines (line l1, line l2)
     return s;
 }
 
-scanlines get_convex_polygon_scanlines (const polygon &p)
+/// @brief walks one chain of polygon edges, one row at a time
+///
+/// The x intercept is stepped with an integer quotient and remainder, so no division is done per row, and the result
+/// is exactly x1 + (y - y1) * (x2 - x1) / (y2 - y1), truncated toward zero.
+template<typename P>
+class edge_walker
 {
-    scanlines s;
-    // for each line in the polygon
-    for (size_t i = 0; i < p.size (); ++i)
+    public:
+    edge_walker (const P &p, const size_t start, const int dir)
+        : p (p), n (p.size ()), i (start), dir (dir)
+    {
+        const point a = round (p[i]);
+        x = a.x;
+        y2 = a.y;
+    }
+    /// @brief advance to the edge that contains row y
+    void seek (const int y)
     {
-        line l1 (round (p[i]), round (p[(i + 1) % p.size ()]));
-        // for each remaining line
-        for (size_t j = i + 1; j < p.size (); ++j)
+        while (y >= y2)
+            next ();
+    }
+    /// @brief get the x intercept of the current row and step to the next row
+    int step ()
+    {
+        const int x0 = x;
+        x += q;
+        err += r;
+        if (err >= dy)
         {
-            line l2 (round (p[j]), round (p[(j + 1) % p.size ()]));
-            std::vector<scanline> t = get_intersecting_scanlines (l1, l2);
-            s.insert (s.end (), t.begin (), t.end ());
+            x += sign;
+            err -= dy;
         }
+        return x0;
+    }
+    private:
+    void next ()
+    {
+        const point a = round (p[i]);
+        i = (i + n + dir) % n;
+        const point b = round (p[i]);
+        const int x1 = a.x;
+        const int y1 = a.y;
+        x = x1;
+        y2 = b.y;
+        dy = y2 - y1;
+        if (dy <= 0)
+        {
+            // horizontal edge, or the walk has reached the bottom
+            q = r = err = 0;
+            dy = 1;
+            return;
+        }
+        const int dx = static_cast<int> (b.x) - x1;
+        sign = dx < 0 ? -1 : 1;
+        q = dx / dy;
+        r = std::abs (dx) % dy;
+        err = 0;
+    }
+    const P &p;
+    const size_t n;
+    size_t i;
+    const int dir;
+    int x = 0;
+    int y2 = 0;
+    int dy = 1;
+    int q = 0;
+    int r = 0;
+    int err = 0;
+    int sign = 1;
+};
+
+/// @brief get the scanlines of a convex polygon
+///
+/// @param p the polygon
+/// @param s scanlines are appended to this container
+///
+/// Starting at the top vertex, the left and right chains of edges are walked down one row at a time.  Vertices are
+/// rounded to the nearest pixel, and each row [y, y + 1) gets one scanline from the edges that cross it.
+template<typename P>
+void get_convex_polygon_scanlines (const P &p, scanlines &s)
+{
+    const size_t n = p.size ();
+    if (n < 3)
+        return;
+    // find the top and bottom rows
+    size_t top = 0;
+    int y1 = ::round (p[0].y);
+    int y2 = y1;
+    for (size_t i = 1; i < n; ++i)
+    {
+        const int y = ::round (p[i].y);
+        if (y < y1)
+        {
+            y1 = y;
+            top = i;
+        }
+        y2 = std::max (y2, y);
+    }
+    if (y2 <= y1)
+        return;
+    s.reserve (s.size () + y2 - y1);
+    edge_walker<P> a (p, top, 1);
+    edge_walker<P> b (p, top, -1);
+    for (int y = y1; y < y2; ++y)
+    {
+        a.seek (y);
+        b.seek (y);
+        int x1 = a.step ();
+        int x2 = b.step ();
+        // make sure the scanline has non-zero length (because of rounding)
+        if (x1 == x2)
+            continue;
+        // make sure x's are ascending
+        if (x2 < x1)
+            std::swap (x1, x2);
+        s.push_back (scanline (y, x1, x2 - x1));
     }
+}
+
+/// @brief get the scanlines of a convex polygon
+///
+/// @param p the polygon
+///
+/// @return the scanlines, in ascending row order
+scanlines get_convex_polygon_scanlines (const polygon &p)
+{
+    scanlines s;
+    get_convex_polygon_scanlines (p, s);
     return s;
 }
 
-scanlines clip (const scanlines &s, const rect &r)
+/// @brief clip scanlines to a rectangle
+///
+/// @param s the scanlines
+/// @param r the rectangle
+/// @param s2 clipped scanlines are appended to this container
+void clip (const scanlines &s, const rect &r, scanlines &s2)
 {
-    scanlines s2;
     // reserves seem to make a difference on ARMv7
-    s2.reserve (s.size ());
+    s2.reserve (s2.size () + s.size ());
     for (auto i : s)
     {
         // clip scanline
@@ -194,6 +323,12 @@ scanlines clip (const scanlines &s, const rect &r)
         assert (x1 < x2);
         s2.push_back (scanline (i.y, x1, x2 - x1));
     }
+}
+
+scanlines clip (const scanlines &s, const rect &r)
+{
+    scanlines s2;
+    clip (s, r, s2);
     return s2;
 }
 
@@ -236,6 +371,238 @@ void fill (T &img, const scanlines &s, unsigned p, const size_t channel)
     }
 }
 
+/// @brief writes runs of one pixel value
+///
+/// The channels of a pixel are written together, instead of one channel at a time.  Gray pixels, whose channels are
+/// all the same, are written with memset.  Otherwise, 16 copies of the pixel, which take a whole number of 16 byte
+/// blocks, are laid out once, and runs are written with 16 byte copies, which compile to vector stores.
+template<size_t CHANNELS>
+class pixel_pattern
+{
+    public:
+    /// @brief constructor
+    ///
+    /// @param p the channels of the pixel, in the order they are stored in memory
+    explicit pixel_pattern (const unsigned char *p)
+        : gray (true)
+    {
+        for (size_t k = 1; k < CHANNELS; ++k)
+            gray = gray && p[k] == p[0];
+        for (size_t i = 0; i < 16; ++i)
+            std::memcpy (pattern + i * CHANNELS, p, CHANNELS);
+    }
+    /// @brief write the pixel n times
+    void fill (unsigned char *dst, const size_t n) const
+    {
+        if (gray)
+        {
+            std::memset (dst, pattern[0], n * CHANNELS);
+            return;
+        }
+        size_t i = 0;
+        for (; i + 16 <= n; i += 16, dst += sizeof (pattern))
+            for (size_t b = 0; b < sizeof (pattern); b += 16)
+                std::memcpy (dst + b, pattern + b, 16);
+        std::memcpy (dst, pattern, (n - i) * CHANNELS);
+    }
+    private:
+    bool gray;
+    unsigned char pattern[16 * CHANNELS];
+};
+
+/// @brief writes runs of one color into an image
+///
+/// Images of any element type can be painted, and 8 bit images are painted with a pixel_pattern.
+template<typename I>
+class span_filler;
+
+template<typename T,size_t CHANNELS,typename Cont,typename Order>
+class span_filler<image<T,CHANNELS,Cont,Order>>
+{
+    public:
+    typedef image<T,CHANNELS,Cont,Order> image_type;
+    template<typename P>
+    span_filler (const image_type &, const P &m)
+    {
+        for (size_t k = 0; k < CHANNELS; ++k)
+            c[k] = m[k];
+    }
+    void fill (image_type &img, const scanline &s) const
+    {
+        for (size_t x = s.x; x < (s.x + s.len); ++x)
+            for (size_t k = 0; k < CHANNELS; ++k)
+                img (s.y, x, k) = c[k];
+    }
+    private:
+    T c[CHANNELS];
+};
+
+template<size_t CHANNELS,typename Cont,typename Order>
+class span_filler<image<unsigned char,CHANNELS,Cont,Order>>
+{
+    public:
+    typedef image<unsigned char,CHANNELS,Cont,Order> image_type;
+    template<typename P>
+    span_filler (const image_type &, const P &m)
+        : p (get_pixel (m).data ())
+    { }
+    void fill (image_type &img, const scanline &s) const
+    {
+        p.fill (&img[0] + (static_cast<size_t> (s.y) * img.cols () + s.x) * CHANNELS, s.len);
+    }
+    private:
+    template<typename P>
+    static std::array<unsigned char,CHANNELS> get_pixel (const P &m)
+    {
+        std::array<unsigned char,CHANNELS> a;
+        for (size_t k = 0; k < CHANNELS; ++k)
+            a[Order::channel (k)] = m[k];
+        return a;
+    }
+    pixel_pattern<CHANNELS> p;
+};
+
+/// @brief fill many regions, each with its own color
+///
+/// @param img the image
+/// @param n the number of regions
+/// @param get_scanlines functor that returns the scanlines of region i
+/// @param get_color functor that returns the color of region i
+///
+/// The image rows are split into one band per thread, and each thread paints the regions in order, so where regions
+/// overlap, the last one wins, exactly like the serial loop.
+template<typename T,typename S,typename M>
+void fill (T &img, const size_t n, S get_scanlines, M get_color)
+{
+    // get the row range of each region so that threads can skip regions outside of their band
+    std::vector<int> miny (n, std::numeric_limits<int>::max ());
+    std::vector<int> maxy (n, std::numeric_limits<int>::lowest ());
+#pragma omp parallel for schedule (dynamic, 256)
+    for (size_t i = 0; i < n; ++i)
+    {
+        for (const auto &j : get_scanlines (i))
+        {
+            miny[i] = std::min (miny[i], j.y);
+            maxy[i] = std::max (maxy[i], j.y);
+        }
+    }
+#pragma omp parallel
+    {
+        const int threads = get_thread_count ();
+        const int t = get_thread_id ();
+        const int rows = img.rows ();
+        const int y1 = static_cast<int64_t> (rows) * t / threads;
+        const int y2 = static_cast<int64_t> (rows) * (t + 1) / threads;
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (maxy[i] < y1 || miny[i] >= y2)
+                continue;
+            const span_filler<T> f (img, get_color (i));
+            for (const auto &j : get_scanlines (i))
+            {
+                if (j.y < y1 || j.y >= y2)
+                    continue;
+                f.fill (img, j);
+            }
+        }
+    }
+}
+
+/// @brief fill many regions, each with its own color
+///
+/// @param img the image
+/// @param ps one set of scanlines for each region
+/// @param m one color for each region
+template<typename T,typename P>
+void fill (T &img, const std::vector<scanlines> &ps, const std::vector<P> &m)
+{
+    assert (ps.size () == m.size ());
+    fill (img, ps.size (),
+        [&] (size_t i) -> const scanlines & { return ps[i]; },
+        [&] (size_t i) -> const P & { return m[i]; });
+}
+
+/// @brief paint the rows of many filled regions one at a time, without an image
+///
+/// Each row is the same as the corresponding row of an image that fill () painted, with a black background, but only
+/// the regions that cross the row are visited.  The scanlines of each region must be sorted by row, and the rows must
+/// be painted from top to bottom.
+template<typename P>
+class scanline_row_painter
+{
+    public:
+    /// @brief constructor
+    ///
+    /// @param cols cols in each row
+    /// @param ps one set of scanlines for each region, which must be clipped to the image
+    /// @param m one color for each region
+    scanline_row_painter (const size_t cols, const std::vector<scanlines> &ps, const std::vector<P> &m)
+        : cols (cols)
+        , ps (ps)
+        , m (m)
+        , next (0)
+        , cursors (ps.size ())
+        , y (0)
+    {
+        assert (ps.size () == m.size ());
+        // visit the regions in the order that they start
+        for (size_t i = 0; i < ps.size (); ++i)
+            if (!ps[i].empty ())
+                order.push_back (i);
+        std::stable_sort (order.begin (), order.end (), [&] (uint32_t a, uint32_t b) { return ps[a][0].y < ps[b][0].y; });
+    }
+    /// @brief paint the next row
+    ///
+    /// @param dst cols interlaced RGB pixels
+    void paint (unsigned char *dst)
+    {
+        std::memset (dst, 0, cols * 3);
+        // add the regions that start on this row, keeping the active regions in painting order
+        const size_t n = active.size ();
+        for (; next < order.size () && ps[order[next]][0].y <= y; ++next)
+            active.push_back (order[next]);
+        if (active.size () != n)
+        {
+            std::sort (active.begin () + n, active.end ());
+            std::inplace_merge (active.begin (), active.begin () + n, active.end ());
+        }
+        size_t k = 0;
+        for (size_t i = 0; i < active.size (); ++i)
+        {
+            const uint32_t j = active[i];
+            const scanlines &s = ps[j];
+            uint32_t &c = cursors[j];
+            for (; c < s.size () && s[c].y < y; ++c)
+                assert (c == 0 || s[c - 1].y <= s[c].y);
+            if (c < s.size () && s[c].y == y)
+            {
+                const unsigned char p[3] = { m[j][0], m[j][1], m[j][2] };
+                const pixel_pattern<3> f (p);
+                for (; c < s.size () && s[c].y == y; ++c)
+                {
+                    assert (s[c].x >= 0);
+                    assert (s[c].x + s[c].len <= cols);
+                    f.fill (dst + s[c].x * 3, s[c].len);
+                }
+            }
+            // keep the region if it has more rows
+            if (c < s.size ())
+                active[k++] = j;
+        }
+        active.resize (k);
+        ++y;
+    }
+    private:
+    const size_t cols;
+    const std::vector<scanlines> &ps;
+    const std::vector<P> &m;
+    std::vector<uint32_t> order;
+    size_t next;
+    std::vector<uint32_t> active;
+    std::vector<uint32_t> cursors;
+    int y;
+};
+
 /// @brief get pixel coordinates of a line drawn from p1 to p2
 std::vector<point> get_line (const point &p1, const point &p2)
 {
@@ -284,13 +651,15 @@ void draw_line (grayscale8_image_t &img, const point &p1, const point &p2, unsig
     }
 }
 
-void draw_lines (grayscale8_image_t &img, const polygon &poly, unsigned p)
+template<typename P>
+void draw_lines (grayscale8_image_t &img, const P &poly, unsigned p)
 {
     for (size_t i = 0; i < poly.size (); ++i)
         draw_line (img, poly[i], poly[(i + 1) % poly.size ()], p);
 }
 
-void draw_line (rgb8_image_t &img, const point &p1, const point &p2, const rgb8_pixel_t &p)
+template<typename C,typename O>
+void draw_line (image<unsigned char,3,C,O> &img, const point &p1, const point &p2, const rgb8_pixel_t &p)
 {
     std::vector<point> pts = get_line (p1, p2);
     const rect img_rect (0, 0, img.cols (), img.rows ());
@@ -307,7 +676,8 @@ void draw_line (rgb8_image_t &img, const point &p1, const point &p2, const rgb8_
     }
 }
 
-void draw_lines (rgb8_image_t &img, const polygon &poly, const rgb8_pixel_t &p)
+template<typename C,typename O,typename P>
+void draw_lines (image<unsigned char,3,C,O> &img, const P &poly, const rgb8_pixel_t &p)
 {
     for (size_t i = 0; i < poly.size (); ++i)
         draw_line (img, poly[i], poly[(i + 1) % poly.size ()], p);
@@ -336,6 +706,164 @@ void alpha_blend (const grayscale8_image_t &a, grayscale8_image_t &b, const doub
         b[i] = alpha * a[i] + (1 - alpha) * b[i];
 }
 
+/// @brief blend two runs of 8 bit values with fixed point arithmetic
+///
+/// @param a the first run
+/// @param b the second run
+/// @param dst the blended run, which may be the same as a or b
+/// @param n the number of values
+/// @param alpha the percentage of a in the blend, from 0 to 100
+///
+/// Each value is (a * alpha + b * (100 - alpha)) / 100, rounded to the nearest integer.  The sums fit in 16 bits, so
+/// the runs are blended in blocks of 16 values that the compiler keeps in vector registers, and the division is done
+/// with a multiply.
+void alpha_blend (const unsigned char *a, const unsigned char *b, unsigned char *dst, const size_t n, const unsigned alpha)
+{
+    assert (alpha <= 100);
+    const uint16_t wa = alpha;
+    const uint16_t wb = 100 - alpha;
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        unsigned char x[16];
+        unsigned char y[16];
+        std::memcpy (x, a + i, 16);
+        std::memcpy (y, b + i, 16);
+        for (size_t j = 0; j < 16; ++j)
+            x[j] = static_cast<uint16_t> (x[j] * wa + y[j] * wb + 50) / 100;
+        std::memcpy (dst + i, x, 16);
+    }
+    for (; i < n; ++i)
+        dst[i] = static_cast<uint16_t> (a[i] * wa + b[i] * wb + 50) / 100;
+}
+
+/// @brief blend two color images
+///
+/// @param a the first image
+/// @param b the second image, which is replaced by the blend
+/// @param alpha the percentage of a in the blend, from 0 to 100
+template<typename C,typename O>
+void alpha_blend (const image<unsigned char,3,C,O> &a, image<unsigned char,3,C,O> &b, const unsigned alpha)
+{
+    assert (a.rows () == b.rows ());
+    assert (a.cols () == b.cols ());
+    if (!b.empty ())
+        alpha_blend (&a[0], &b[0], &b[0], b.size (), alpha);
+}
+
+/// @brief composite a mosaic with the image it was made from, and overlay outlines
+///
+/// @param original the image
+/// @param mosaic the tiled image
+/// @param transparency the percentage of the original that shows through
+/// @param outlines pixels that are not 0 are painted with the outline color, or empty for no outlines
+/// @param color the outline color
+/// @param dst the composite, which is resized to fit
+///
+/// Each row of dst is blended and outlined while it is in cache, so the composite is written in one pass, which
+/// gives the same image as blending with alpha_blend () and then drawing the outlines.
+template<typename C,typename O>
+void composite_image (const image<unsigned char,3,C,O> &original, const image<unsigned char,3,C,O> &mosaic, const unsigned transparency, const grayscale8_image_t &outlines, const rgb8_pixel_t &color, image<unsigned char,3,C,O> &dst)
+{
+    assert (original.rows () == mosaic.rows ());
+    assert (original.cols () == mosaic.cols ());
+    assert (outlines.empty () || outlines.rows () == mosaic.rows ());
+    assert (outlines.empty () || outlines.cols () == mosaic.cols ());
+    if (dst.rows () != mosaic.rows () || dst.cols () != mosaic.cols ())
+        dst = image<unsigned char,3,C,O> (mosaic.rows (), mosaic.cols ());
+    // the outline color, in the order it is stored in memory
+    unsigned char p[3];
+    for (size_t k = 0; k < 3; ++k)
+        p[O::channel (k)] = color[k];
+    const size_t n = mosaic.cols () * 3;
+#pragma omp parallel for
+    for (size_t i = 0; i < mosaic.rows (); ++i)
+    {
+        unsigned char *d = &dst[i * n];
+        if (transparency == 0)
+            std::memcpy (d, &mosaic[i * n], n);
+        else
+            alpha_blend (&original[i * n], &mosaic[i * n], d, n, transparency);
+        if (outlines.empty ())
+            continue;
+        const unsigned char *o = &outlines (i, 0);
+        for (size_t j = 0; j < mosaic.cols (); ++j)
+            if (o[j])
+                std::memcpy (d + j * 3, p, 3);
+    }
+}
+
+/// @brief shrink an image by averaging blocks of f x f pixels
+///
+/// Blocks on the right and bottom edges may be smaller.  Elements must be 8 bit.
+template<typename I>
+I shrink (const I &img, const size_t f)
+{
+    assert (f != 0);
+    const size_t ch = img.channels ();
+    I s ((img.rows () + f - 1) / f, (img.cols () + f - 1) / f);
+#pragma omp parallel for
+    for (size_t r = 0; r < s.rows (); ++r)
+    {
+        const size_t r1 = r * f;
+        const size_t r2 = std::min (img.rows (), r1 + f);
+        // sum the rows of the block, then the columns
+        std::vector<uint32_t> sums (img.cols () * ch);
+        for (size_t i = r1; i < r2; ++i)
+        {
+            const auto *src = &img[i * img.cols () * ch];
+            for (size_t j = 0; j < sums.size (); ++j)
+                sums[j] += src[j];
+        }
+        for (size_t c = 0; c < s.cols (); ++c)
+        {
+            const size_t c1 = c * f;
+            const size_t c2 = std::min (img.cols (), c1 + f);
+            const size_t n = (r2 - r1) * (c2 - c1);
+            for (size_t k = 0; k < ch; ++k)
+            {
+                uint64_t sum = 0;
+                for (size_t j = c1; j < c2; ++j)
+                    sum += sums[j * ch + k];
+                s[(r * s.cols () + c) * ch + k] = (sum + n / 2) / n;
+            }
+        }
+    }
+    return s;
+}
+
+/// @brief enlarge an image by replicating each pixel f x f times
+///
+/// @param s the image to enlarge
+/// @param f the enlargement factor
+/// @param img the enlarged image, which may be smaller than f times the size of s
+template<typename I>
+void enlarge (const I &s, const size_t f, I &img)
+{
+    assert (f != 0);
+    assert (s.rows () * f >= img.rows ());
+    assert (s.cols () * f >= img.cols ());
+    const size_t ch = img.channels ();
+    const size_t n = img.cols () * ch;
+#pragma omp parallel for
+    for (size_t r = 0; r < s.rows (); ++r)
+    {
+        const size_t r1 = r * f;
+        const size_t r2 = std::min (img.rows (), r1 + f);
+        if (r1 >= r2)
+            continue;
+        // expand the first row of the block, then copy it
+        const auto *src = &s[r * s.cols () * ch];
+        auto *dst = &img[r1 * n];
+        for (size_t c = 0; c < img.cols (); c += f, src += ch)
+            for (size_t j = 0; j < std::min (f, img.cols () - c); ++j)
+                for (size_t k = 0; k < ch; ++k)
+                    *dst++ = src[k];
+        for (size_t i = r1 + 1; i < r2; ++i)
+            std::copy (&img[r1 * n], &img[r1 * n] + n, &img[i * n]);
+    }
+}
+
 points create_elliptical_path (
     const unsigned w,
     const unsigned h,
@@ -7,9 +7,15 @@
 #ifndef IMAGE_HPP
 #define IMAGE_HPP
 
+#include <algorithm>
+#include <array>
 #include <cassert>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
 #include <stdexcept>
-#include <array>
+#include <utility>
 #include <vector>
 
 namespace image_tiler
@@ -18,22 +24,166 @@ namespace image_tiler
 template<typename T,size_t CHANNELS>
 struct pixel
 {
-    std::vector<T> c;
-    pixel () : c (CHANNELS)  { }
-    pixel (std::initializer_list<T> l) : c (l)  { }
+    // fixed size, so pixels never allocate
+    std::array<T,CHANNELS> c;
+    pixel () { c.fill (T ()); }
+    pixel (std::initializer_list<T> l)
+    {
+        assert (l.size () <= CHANNELS);
+        c.fill (T ());
+        std::copy (l.begin (), l.begin () + std::min (l.size (), CHANNELS), c.begin ());
+    }
+    size_t size () const { return CHANNELS; }
     // write
     T & operator[] (size_t i) { return c[i]; }
     // read
     const T & operator[] (size_t i) const { return c[i]; }
+    friend bool operator== (const pixel &a, const pixel &b) { return a.c == b.c; }
+    friend bool operator!= (const pixel &a, const pixel &b) { return a.c != b.c; }
 };
 
 typedef pixel<unsigned char,3> rgb8_pixel_t;
 
-template<typename T, size_t CHANNELS, class Cont = std::vector<T>>
+/// @brief channels are stored in the order in which they are indexed
+struct rgb_order
+{
+    static constexpr size_t channel (const size_t k) { return k; }
+};
+
+/// @brief the first three channels are stored in reverse order, like OpenCV's BGR images
+struct bgr_order
+{
+    static constexpr size_t channel (const size_t k) { return k < 3 ? 2 - k : k; }
+};
+
+/// @brief a fixed size, vector-like container that refers to memory owned by some other object
+///
+/// The owner is kept alive for as long as the container refers to its memory, so, for example, a memory mapping or
+/// an OpenCV matrix may be used as an image without copying it.  Copies are deep, and are backed by a vector.
+template<typename T>
+class buffer_container
+{
+    public:
+    typedef buffer_container<T> self_type;
+    typedef T value_type;
+    typedef T *pointer;
+    typedef const T *const_pointer;
+    typedef T &reference;
+    typedef const T &const_reference;
+    typedef size_t size_type;
+    typedef ptrdiff_t difference_type;
+    typedef std::allocator<T> allocator_type;
+    typedef T *iterator;
+    typedef const T *const_iterator;
+    typedef std::reverse_iterator<iterator> reverse_iterator;
+    typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+    /// @brief Default constructor
+    buffer_container ()
+        : data_ (nullptr), size_ (0)
+    { }
+    /// @brief Refer to memory owned by another object
+    /// @param data the first element
+    /// @param n number of elements
+    /// @param owner the object that owns the memory
+    buffer_container (T *data, const size_t n, const std::shared_ptr<void> &owner)
+        : owner_ (owner), data_ (data), size_ (n)
+    { }
+    /// @brief Size constructor
+    buffer_container (const size_t n, const T &v = T ())
+        : data_ (nullptr), size_ (0)
+    {
+        allocate (n);
+        std::fill (begin (), end (), v);
+    }
+    /// @brief Copy constructor
+    buffer_container (const self_type &c)
+        : data_ (nullptr), size_ (0)
+    {
+        allocate (c.size_);
+        std::copy (c.begin (), c.end (), begin ());
+    }
+    /// @brief Move constructor
+    buffer_container (self_type &&c)
+        : data_ (nullptr), size_ (0)
+    {
+        swap (c);
+    }
+    /// @brief Assignment
+    self_type &operator= (self_type c)
+    {
+        swap (c);
+        return *this;
+    }
+    void swap (self_type &c)
+    {
+        std::swap (owner_, c.owner_);
+        std::swap (data_, c.data_);
+        std::swap (size_, c.size_);
+    }
+
+    size_t size () const { return size_; }
+    bool empty () const { return size_ == 0; }
+    void assign (const size_t n, const T &v)
+    {
+        assert (n == size_);
+        std::fill (begin (), begin () + n, v);
+    }
+    pointer data () { return data_; }
+    const_pointer data () const { return data_; }
+
+    reference front () { return data_[0]; }
+    const_reference front () const { return data_[0]; }
+    reference back () { return data_[size_ - 1]; }
+    const_reference back () const { return data_[size_ - 1]; }
+    reference operator[] (size_t i) { return data_[i]; }
+    const_reference operator[] (size_t i) const { return data_[i]; }
+    reference at (size_t i)
+    {
+        if (i >= size_)
+            throw std::out_of_range ("buffer_container");
+        return data_[i];
+    }
+    const_reference at (size_t i) const
+    {
+        if (i >= size_)
+            throw std::out_of_range ("buffer_container");
+        return data_[i];
+    }
+
+    iterator begin () { return data_; }
+    const_iterator begin () const { return data_; }
+    iterator end () { return data_ + size_; }
+    const_iterator end () const { return data_ + size_; }
+    reverse_iterator rbegin () { return reverse_iterator (end ()); }
+    const_reverse_iterator rbegin () const { return const_reverse_iterator (end ()); }
+    reverse_iterator rend () { return reverse_iterator (begin ()); }
+    const_reverse_iterator rend () const { return const_reverse_iterator (begin ()); }
+
+    friend bool operator== (const self_type &a, const self_type &b)
+    {
+        return a.size_ == b.size_ && std::equal (a.begin (), a.end (), b.begin ());
+    }
+
+    private:
+    void allocate (const size_t n)
+    {
+        std::shared_ptr<std::vector<T>> v = std::make_shared<std::vector<T>> (n);
+        owner_ = v;
+        data_ = v->data ();
+        size_ = n;
+    }
+    std::shared_ptr<void> owner_;
+    T *data_;
+    size_t size_;
+};
+
+template<typename T, size_t CHANNELS, class Cont = std::vector<T>, class Order = rgb_order>
 class image
 {
     public:
-    typedef image<T,CHANNELS,Cont> self_type;
+    typedef image<T,CHANNELS,Cont,Order> self_type;
+    typedef Order order_type;
     typedef typename Cont::value_type value_type;
     typedef typename Cont::pointer pointer;
     typedef typename Cont::const_pointer const_pointer;
@@ -58,11 +208,26 @@ class image
     image (size_t rows, size_t cols, const T &v = T ())
         : rows_ (rows), cols_ (cols), cont_ (rows * cols * CHANNELS, v)
     { }
+    /// @brief Container constructor
+    /// @param rows number of rows in image
+    /// @param cols number of columns in image
+    /// @param c container that holds the elements, which is moved into the image
+    image (size_t rows, size_t cols, Cont &&c)
+        : rows_ (rows), cols_ (cols), cont_ (std::move (c))
+    { assert (cont_.size () == rows * cols * CHANNELS); }
     /// @brief Copy constructor
     /// @param m image to copy
     image (const self_type &m)
         : rows_ (m.rows_), cols_ (m.cols_), cont_ (m.cont_)
     { }
+    /// @brief Move constructor
+    /// @param m image to move
+    image (self_type &&m)
+        : rows_ (m.rows_), cols_ (m.cols_), cont_ (std::move (m.cont_))
+    {
+        m.rows_ = 0;
+        m.cols_ = 0;
+    }
 
     /// @brief Get dimensions
     /// @return the number of rows
@@ -102,6 +267,12 @@ class image
         }
         return *this;
     }
+    /// @brief Move assignment
+    self_type &operator= (self_type &&rhs)
+    {
+        swap (rhs);
+        return *this;
+    }
     /// @brief Assign all element values
     /// @param v value to assign
     void assign (const T &v)
@@ -203,7 +374,10 @@ class image
     /// @param c element col
     /// @param k element channel
     size_t index (size_t r, size_t c, size_t k) const
-    { return r * cols_ * CHANNELS + c * CHANNELS + k; }
+    { return r * cols_ * CHANNELS + c * CHANNELS + Order::channel (k); }
+    /// @brief Get the container that holds the elements
+    const Cont &container () const
+    { return cont_; }
 
     /// @brief Remove all elements
     void clear ()
@@ -213,8 +387,8 @@ class image
     }
 
     /// @brief Compare two images
-    template<typename M,typename C>
-    friend bool operator== (const image<M,CHANNELS,C> &a, const image<M,CHANNELS,C> &b);
+    template<typename M,size_t N,typename C,typename O>
+    friend bool operator== (const image<M,N,C,O> &a, const image<M,N,C,O> &b);
 
     private:
     size_t rows_;
@@ -223,8 +397,8 @@ class image
 };
 
 /// @brief Compare two images
-template<typename T,size_t CHANNELS,typename Cont>
-inline bool operator== (const image<T,CHANNELS,Cont> &a, const image<T,CHANNELS,Cont> &b)
+template<typename T,size_t CHANNELS,typename Cont,typename Order>
+inline bool operator== (const image<T,CHANNELS,Cont,Order> &a, const image<T,CHANNELS,Cont,Order> &b)
 {
     return a.rows_ == b.rows_ &&
         a.cols_ == b.cols_ &&
@@ -232,8 +406,8 @@ inline bool operator== (const image<T,CHANNELS,Cont> &a, const image<T,CHANNELS,
 }
 
 /// @brief Compare two images
-template<typename T,size_t CHANNELS,typename Cont>
-inline bool operator!= (const image<T,CHANNELS,Cont> &a, const image<T,CHANNELS,Cont> &b)
+template<typename T,size_t CHANNELS,typename Cont,typename Order>
+inline bool operator!= (const image<T,CHANNELS,Cont,Order> &a, const image<T,CHANNELS,Cont,Order> &b)
 {
     return !(a == b);
 }
@@ -0,0 +1,111 @@
+/// @file image_elements.h
+/// @brief the polygons, scanlines and colors of a tiled image
+/// @author Jeff Perry <jeffsp@gmail.com>
+/// @version 1.0
+/// @date 2014-07-27
+
+#ifndef IMAGE_ELEMENTS_H
+#define IMAGE_ELEMENTS_H
+
+#include "geometry.h"
+#include "graphics.h"
+#include "image.h"
+#include "polygon_soup.h"
+#include "pyramid.h"
+#include "raster_cache.h"
+#include "stats.h"
+#include "tiler.h"
+#include <utility>
+#include <vector>
+
+namespace image_tiler
+{
+
+/// @brief the elements of a tiled image
+///
+/// Element i is made up of p[i], s[i] and m[i].  The members are kept in separate containers so that, for example,
+/// the colors are contiguous.  The scanlines may be empty if the elements were not rasterized to scanlines.
+struct image_elements
+{
+    /// @brief polygons
+    polygon_soup p;
+    /// @brief clipped scanlines of each polygon
+    polygon_scanlines s;
+    /// @brief color of each polygon
+    std::vector<rgb8_pixel_t> m;
+
+    /// @brief get the number of elements
+    size_t size () const { return p.size (); }
+    /// @brief indicates if there are no elements
+    bool empty () const { return p.empty (); }
+};
+
+/// @brief get the colors of each region from its statistics
+template<size_t CHANNELS>
+std::vector<rgb8_pixel_t> get_colors (const std::vector<region_stats<CHANNELS>> &st)
+{
+    std::vector<rgb8_pixel_t> m (st.size ());
+    for (size_t i = 0; i < m.size (); ++i)
+        for (size_t j = 0; j < m[i].size (); ++j)
+            m[i][j] = st[i].mean[j];
+    return m;
+}
+
+/// @brief rasterize polygons and get their mean colors
+///
+/// @param img the image
+/// @param p the polygons, which are moved into the returned elements
+///
+/// @return the image elements
+template<typename T>
+image_elements get_image_elements (const T &img, polygon_soup p)
+{
+    image_elements e;
+    // clip scanlines that don't overlap
+    e.s = clip_scanlines (img.cols (), img.rows (), get_polygon_scanlines (p));
+    // get mean pixel values
+    e.m = get_colors (get_region_stats (img, e.s));
+    e.p = std::move (p);
+    return e;
+}
+
+/// @brief rasterize tiled polygons, reusing the scanlines of repeated shapes, and get their mean colors
+///
+/// @param img the image
+/// @param p the polygons, which are moved into the returned elements
+/// @param prototypes the prototypes of the polygons, from get_prototype_polygons ()
+/// @param mode how repeated shapes are matched
+///
+/// @return the image elements
+template<typename T>
+image_elements get_image_elements (const T &img, polygon_soup p, const polygons &prototypes, const raster_cache_mode mode)
+{
+    image_elements e;
+    e.s = clip_scanlines (img.cols (), img.rows (), get_polygon_scanlines (p, prototypes, mode));
+    e.m = get_colors (get_region_stats (img, e.s));
+    e.p = std::move (p);
+    return e;
+}
+
+/// @brief rasterize tiled polygons, and get their mean colors from a pyramid
+///
+/// @param pyr the pyramid of the image
+/// @param p the polygons, which are moved into the returned elements
+/// @param prototypes the prototypes of the polygons, from get_prototype_polygons ()
+/// @param mode how repeated shapes are matched
+/// @param min_pixels each mean is taken from the coarsest level on which its polygon covers this many pixels
+///
+/// @return the image elements
+template<typename T>
+image_elements get_image_elements (const image_pyramid<T> &pyr, polygon_soup p, const polygons &prototypes, const raster_cache_mode mode, const size_t min_pixels)
+{
+    image_elements e;
+    e.s = clip_scanlines (pyr[0].cols (), pyr[0].rows (), get_polygon_scanlines (p, prototypes, mode));
+    e.m = get_colors (get_region_stats (pyr, e.s, min_pixels));
+    e.p = std::move (p);
+    return e;
+}
+
+} // namespace image_tiler
+
+#endif // IMAGE_ELEMENTS_H
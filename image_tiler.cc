@@ -5,115 +5,627 @@
 /// @date 2014-07-20
 
 #include "image_tiler.h"
+#include <cstdio>
+#include <cstring>
 #include <getopt.h>
 
 using namespace std;
 using namespace image_tiler;
 
-const string usage = "image_tiler [options] <infile> <outfile>";
+const string usage = "image_tiler [options] <infile> <outfile>\n\timage_tiler [options] --batch <manifest|directory> <outdir>\n\timage_tiler [options] --tiles|--scales|--angles <list> <infile> <outfile|outdir>";
 
-polygons get_window_polys (const rgb8_image_t &img, const convex_uniform_tile &t, double scale, double angle)
+// output file type
+enum class of { svg, svg_instanced, scene, jpeg };
+
+// how polygons are rasterized and averaged
+enum class en { scanlines, labels, stream, coverage };
+
+// the extension of output files, including the dot
+const char *get_output_extension (const of output_format)
+{
+    switch (output_format)
+    {
+        default: throw runtime_error ("Unknown output type");
+        case of::jpeg: return ".jpg";
+        case of::svg: return ".svg";
+        case of::svg_instanced: return ".svg";
+        case of::scene: return ".scene";
+    }
+}
+
+polygon_soup get_window_polys (const size_t rows, const size_t cols, const convex_uniform_tile &t, double scale, double angle, const bool partial = false)
 {
     // get locations
     const double tw = scale * t.get_width ();
     const double th = scale * t.get_height ();
-    const auto locs = get_tile_locations (img.rows (), img.cols (), point (img.cols () / 2.0, img.rows () / 2.0), tw, th, angle, t.is_triangular ());
+    const auto locs = get_window_tile_locations (rows, cols, point (cols / 2.0, rows / 2.0), tw, th, angle, t.is_triangular (), get_tile_extent (t.get_polygons (), scale, angle));
     std::clog << locs.size () << " tiles locations" << std::endl;
     // get the polygons
-    const polygons all_polys = get_tiled_polygons (locs, t.get_polygons (), scale, angle);
+    const polygon_soup all_polys = get_tiled_polygon_soup (locs, t.get_polygons (), scale, angle);
     std::clog << all_polys.size () << " unclipped polygons" << std::endl;
-    // filter out tiles that don't intersect
-    const polygons window_polys = get_intersecting_polygons (img.cols (), img.rows (), all_polys);
-    return window_polys;
+    // filter out tiles that don't intersect, or that don't cover any part of a pixel
+    return partial ? get_covering_polygons (cols, rows, all_polys) : get_intersecting_polygons (cols, rows, all_polys);
 }
 
-struct image_element
+template<typename T>
+polygon_soup get_window_polys (const T &img, const convex_uniform_tile &t, double scale, double angle, const bool partial = false)
 {
-    polygon p;
-    scanlines s;
-    rgb8_pixel_t m;
-};
+    return get_window_polys (img.rows (), img.cols (), t, scale, angle, partial);
+}
 
-typedef std::vector<image_element> image_elements;
+template<typename Source>
+void write_bands (Source &src, const std::string &fn, const convex_uniform_tile &t, double scale, double angle, const size_t band_rows)
+{
+    // the polygons are generated as the bands are read
+    size_t n = 0;
+    if (is_ppm_filename (fn))
+    {
+        // stream the output, too
+        ppm_band_writer dst (fn, src.rows (), src.cols ());
+        n = tile_bands (src, dst, t, scale, angle, band_rows);
+    }
+    else if (get_extension (fn) == "png")
+    {
+        png_row_writer dst (fn, src.rows (), src.cols ());
+        n = tile_bands (src, dst, t, scale, angle, band_rows);
+    }
+    else if (get_extension (fn) == "jpg" || get_extension (fn) == "jpeg")
+    {
+        jpeg_row_writer dst (fn, src.rows (), src.cols ());
+        n = tile_bands (src, dst, t, scale, angle, band_rows);
+    }
+    else
+    {
+        // other formats are encoded from a full image
+        rgb8_image_t img (src.rows (), src.cols ());
+        image_band_writer dst (img);
+        n = tile_bands (src, dst, t, scale, angle, band_rows);
+        write_image (fn, img);
+    }
+    std::clog << n << " clipped polygons" << std::endl;
+}
 
-image_elements get_image_elements (const rgb8_image_t &img, const convex_uniform_tile &t, double scale, double angle)
+template<typename T>
+image_elements get_image_elements (const T &img, const convex_uniform_tile &t, double scale, double angle, const raster_cache_mode rc, const size_t min_pixels)
 {
-    const polygons window_polys = get_window_polys (img, t, scale, angle);
+    polygon_soup window_polys = get_window_polys (img, t, scale, angle);
     std::clog << window_polys.size () << " clipped polygons" << std::endl;
-    // clip scanlines that don't overlap
-    const polygon_scanlines ps = clip_scanlines (img.cols (), img.rows (), get_polygon_scanlines (window_polys));
-    std::clog << ps.size () << " groups of scanlines" << std::endl;
-    // get mean pixel values
-    std::vector<rgb8_pixel_t> m (ps.size ());
-    for (size_t i = 0; i < m.size (); ++i)
-        for (auto j : { 0, 1, 2 })
-            m[i][j] = get_mean (img, ps[i], j);
-    image_elements e (m.size ());
-    for (size_t i = 0; i < m.size (); ++i)
-    {
-        e[i].p = window_polys[i];
-        e[i].s = ps[i];
-        e[i].m = m[i];
+    const polygons prototypes = get_prototype_polygons (t.get_polygons (), scale, angle);
+    image_elements e;
+    if (min_pixels == 0)
+        e = get_image_elements (img, std::move (window_polys), prototypes, rc);
+    else
+    {
+        // draft means
+        const image_pyramid<T> pyr (img);
+        std::clog << pyr.size () << " pyramid levels" << std::endl;
+        e = get_image_elements (pyr, std::move (window_polys), prototypes, rc, min_pixels);
+    }
+    std::clog << e.s.size () << " groups of scanlines" << std::endl;
+    return e;
+}
+
+template<typename T>
+image_elements get_image_elements (const T &img, const convex_uniform_tile &t, double scale, double angle, label_map_t &l)
+{
+    image_elements e;
+    e.p = get_window_polys (img, t, scale, angle);
+    std::clog << e.p.size () << " clipped polygons" << std::endl;
+    // rasterize all polygons at once
+    l = get_label_map (img.rows (), img.cols (), e.p);
+    // get mean pixel values in one pass over the image
+    e.m = get_colors (get_label_stats (img, l, e.p.size ()));
+    return e;
+}
+
+template<typename T>
+image_elements get_image_elements (const T &img, const convex_uniform_tile &t, double scale, double angle, polygon_coverage &c)
+{
+    const polygon_soup p = get_window_polys (img, t, scale, angle, true);
+    // the exact area of each pixel that each polygon covers
+    polygon_coverage pc = get_polygon_coverage (img.rows (), img.cols (), p);
+    // polygons that only graze the window cover nothing
+    image_elements e;
+    c.clear ();
+    for (size_t i = 0; i < p.size (); ++i)
+    {
+        if (pc[i].empty ())
+            continue;
+        e.p.push_back (p[i]);
+        c.push_back (std::move (pc[i]));
     }
+    std::clog << e.p.size () << " covering polygons" << std::endl;
+    // coverage weighted means
+    e.m = get_colors (get_region_stats (img, c));
     return e;
 }
 
+bgr8_image_t render (const label_map_t &l, const image_elements &e)
+{
+    // paint in the encoder's channel order so that it does not have to convert
+    bgr8_image_t img = create_bgr_image (l.rows (), l.cols ());
+    paint_label_map (l, e.m, img);
+    return img;
+}
+
+bgr8_image_t render (const size_t w, const size_t h, const image_elements &e)
+{
+    bgr8_image_t img = create_bgr_image (h, w);
+    fill (img, e.s, e.m);
+    return img;
+}
+
+bgr8_image_t render (const size_t w, const size_t h, const polygon_coverage &c, const image_elements &e)
+{
+    // anti-aliased, the edges are added to a black background
+    bgr8_image_t img = create_bgr_image (h, w);
+    fill (img, c, e.m);
+    return img;
+}
+
+void write_jpg (const std::string &fn, const label_map_t &l, const image_elements &e)
+{
+    if (is_row_writer_filename (fn))
+    {
+        // encode each row as soon as it is painted
+        size_t r = 0;
+        write_rows (fn, l.rows (), l.cols (), [&] (unsigned char *dst) { paint_label_map_row (l, e.m, r++, dst); });
+        return;
+    }
+    write_image (fn, render (l, e));
+}
+
 void write_jpg (const std::string &fn, const size_t w, const size_t h, const image_elements &e)
 {
-    rgb8_image_t img (h, w);
-    for (size_t i = 0; i < e.size (); ++i)
-        for (auto j : { 0, 1, 2})
-            fill (img, e[i].s, e[i].m[j], j);
-    write_image (fn, img);
+    if (is_row_writer_filename (fn))
+    {
+        // paint each row from the spans that cross it, so there is never a full image
+        scanline_row_painter<rgb8_pixel_t> p (w, e.s, e.m);
+        write_rows (fn, h, w, [&] (unsigned char *dst) { p.paint (dst); });
+        return;
+    }
+    write_image (fn, render (w, h, e));
 }
 
-void write_svg (std::ostream &s, const size_t w, const size_t h, const image_elements &e)
+void write_jpg (const std::string &fn, const size_t w, const size_t h, const polygon_coverage &c, const image_elements &e)
 {
-    // write svg header
-    s << "<svg currentScale=\"1.0\" width=\"" << w << "\" height=\"" << h << "\" viewBox=\"0 0 " << w << " " << h << "\">" << std::endl;
-    for (size_t i = 0; i < e.size (); ++i)
+    if (is_row_writer_filename (fn))
+    {
+        // paint each row from the whole pixels and edges that cross it, so there is never a full image
+        coverage_row_painter<rgb8_pixel_t> p (w, c, e.m);
+        write_rows (fn, h, w, [&] (unsigned char *dst) { p.paint (dst); });
+        return;
+    }
+    write_image (fn, render (w, h, c, e));
+}
+
+// the stream engine generates the geometry twice, once to get the colors and once to draw them, and never stores it
+template<typename T>
+std::vector<rgb8_pixel_t> get_streamed_colors (const T &img, const convex_uniform_tile &t, double scale, double angle)
+{
+    std::vector<rgb8_pixel_t> m;
+    visit_window_scanlines (img.rows (), img.cols (), point (img.cols () / 2.0, img.rows () / 2.0), t, scale, angle,
+        [&] (const polygon &, const scanlines &s)
+        {
+            const auto st = get_region_stats (img, s);
+            rgb8_pixel_t c;
+            for (size_t k = 0; k < c.size (); ++k)
+                c[k] = st.mean[k];
+            m.push_back (c);
+        });
+    std::clog << m.size () << " clipped polygons" << std::endl;
+    return m;
+}
+
+bgr8_image_t render_streamed (const size_t w, const size_t h, const convex_uniform_tile &t, double scale, double angle, const std::vector<rgb8_pixel_t> &m)
+{
+    bgr8_image_t img = create_bgr_image (h, w);
+    size_t i = 0;
+    visit_window_scanlines (h, w, point (w / 2.0, h / 2.0), t, scale, angle,
+        [&] (const polygon &, const scanlines &s)
+        {
+            const span_filler<bgr8_image_t> f (img, m[i++]);
+            for (const auto &j : s)
+                f.fill (img, j);
+        });
+    return img;
+}
+
+void write_streamed_jpg (const std::string &fn, const size_t w, const size_t h, const convex_uniform_tile &t, double scale, double angle, const std::vector<rgb8_pixel_t> &m)
+{
+    if (is_row_writer_filename (fn))
     {
-        // write svg polygon
-        s << "<polygon points=\"";
-        for (const auto &j : e[i].p)
-            s << " " << j.x << ',' << j.y;
-        std::stringstream color;
-        color << "#"
-            << std::hex
-            << std::setfill ('0') << std::setw (2) << static_cast<int> (e[i].m[0])
-            << std::setfill ('0') << std::setw (2) << static_cast<int> (e[i].m[1])
-            << std::setfill ('0') << std::setw (2) << static_cast<int> (e[i].m[2]);
-        s << "\" style=\"stroke:"
-            << color.str ()
-            << ";stroke-width:1px;fill:"
-            << color.str ()
-            << ";\" />"
-            << std::endl;
-    }
-    s << "Sorry, your browser does not support inline SVG." << std::endl;
-    s << "</svg>" << std::endl;
-}
-
-void write_svg (const std::string &fn, const size_t w, const size_t h, const image_elements &e)
+        // place and rasterize each tile when its first row is painted, so there is never a full image
+        window_row_painter p (h, w, point (w / 2.0, h / 2.0), t, scale, angle, m);
+        write_rows (fn, h, w, [&] (unsigned char *dst) { p.paint (dst); });
+        return;
+    }
+    write_image (fn, render_streamed (w, h, t, scale, angle, m));
+}
+
+void write_streamed_svg (const std::string &fn, const size_t w, const size_t h, const convex_uniform_tile &t, double scale, double angle, const std::vector<rgb8_pixel_t> &m, const bool instanced)
 {
     std::ofstream ofs (fn.c_str ());
     if (!ofs)
         throw std::runtime_error ("could not open file for writing");
-    write_svg (ofs, w, h, e);
+    size_t i = 0;
+    if (instanced)
+    {
+        const svg_instances si (t, scale, angle);
+        si.write_header (ofs, w, h);
+        visit_window_polygons (h, w, point (w / 2.0, h / 2.0), t, scale, angle,
+            [&] (const polygon &p) { si.write_polygon (ofs, p, m[i++]); });
+        si.write_footer (ofs);
+        return;
+    }
+    write_svg_header (ofs, w, h);
+    visit_window_polygons (h, w, point (w / 2.0, h / 2.0), t, scale, angle,
+        [&] (const polygon &p) { write_svg_polygon (ofs, p, m[i++]); });
+    write_svg_footer (ofs);
+}
+
+void write_scene (const std::string &fn, const size_t w, const size_t h, const convex_uniform_tile &t, double scale, double angle, const image_elements &e)
+{
+    scene_builder b (h, w, point (w / 2.0, h / 2.0), t, scale, angle);
+    for (size_t i = 0; i < e.size (); ++i)
+        b.add (e.p[i], e.m[i]);
+    b.write (fn);
+}
+
+void write_streamed_scene (const std::string &fn, const size_t w, const size_t h, const convex_uniform_tile &t, double scale, double angle, const std::vector<rgb8_pixel_t> &m)
+{
+    scene_builder b (h, w, point (w / 2.0, h / 2.0), t, scale, angle);
+    size_t i = 0;
+    visit_window_polygons (h, w, point (w / 2.0, h / 2.0), t, scale, angle,
+        [&] (const polygon &p) { b.add (p, m[i++]); });
+    b.write (fn);
+}
+
+template<typename T>
+void write_tiled_image (const T &img, const std::string &fn, const of output_format, const en engine, const raster_cache_mode rc, const size_t min_pixels, const convex_uniform_tile &t, double scale, double angle)
+{
+    std::clog << "width " << img.cols () << std::endl;
+    std::clog << "height " << img.rows () << std::endl;
+    if (engine == en::labels)
+    {
+        label_map_t l;
+        const image_elements e = get_image_elements (img, t, scale, angle, l);
+        std::clog << "writing to " << fn << std::endl;
+        switch (output_format)
+        {
+            default: throw runtime_error ("Unknown output type");
+            case of::jpeg: write_jpg (fn, l, e); break;
+            case of::svg: write_svg (fn, img.cols (), img.rows (), e); break;
+            case of::svg_instanced: write_instanced_svg (fn, img.cols (), img.rows (), t, scale, angle, e); break;
+            case of::scene: write_scene (fn, img.cols (), img.rows (), t, scale, angle, e); break;
+        }
+        return;
+    }
+    if (engine == en::coverage)
+    {
+        polygon_coverage c;
+        const image_elements e = get_image_elements (img, t, scale, angle, c);
+        std::clog << "writing to " << fn << std::endl;
+        switch (output_format)
+        {
+            default: throw runtime_error ("Unknown output type");
+            case of::jpeg: write_jpg (fn, img.cols (), img.rows (), c, e); break;
+            case of::svg: write_svg (fn, img.cols (), img.rows (), e); break;
+            case of::svg_instanced: write_instanced_svg (fn, img.cols (), img.rows (), t, scale, angle, e); break;
+            case of::scene: write_scene (fn, img.cols (), img.rows (), t, scale, angle, e); break;
+        }
+        return;
+    }
+    if (engine == en::stream)
+    {
+        const std::vector<rgb8_pixel_t> m = get_streamed_colors (img, t, scale, angle);
+        std::clog << "writing to " << fn << std::endl;
+        switch (output_format)
+        {
+            default: throw runtime_error ("Unknown output type");
+            case of::jpeg: write_streamed_jpg (fn, img.cols (), img.rows (), t, scale, angle, m); break;
+            case of::svg:
+            case of::svg_instanced:
+            write_streamed_svg (fn, img.cols (), img.rows (), t, scale, angle, m, output_format == of::svg_instanced);
+            break;
+            case of::scene: write_streamed_scene (fn, img.cols (), img.rows (), t, scale, angle, m); break;
+        }
+        return;
+    }
+    const image_elements e = get_image_elements (img, t, scale, angle, rc, min_pixels);
+    std::clog << "writing to " << fn << std::endl;
+    switch (output_format)
+    {
+        default: throw runtime_error ("Unknown output type");
+        case of::jpeg: write_jpg (fn, img.cols (), img.rows (), e); break;
+        case of::svg: write_svg (fn, img.cols (), img.rows (), e); break;
+        case of::svg_instanced: write_instanced_svg (fn, img.cols (), img.rows (), t, scale, angle, e); break;
+        case of::scene: write_scene (fn, img.cols (), img.rows (), t, scale, angle, e); break;
+    }
+}
+
+bgr8_image_t decode_image (const std::string &fn, const size_t raw_rows, const size_t raw_cols)
+{
+    if (is_ppm_filename (fn))
+        return to_bgr_image (map_ppm_image (fn));
+    if (get_extension (fn) == "rgb")
+    {
+        if (raw_rows == 0 || raw_cols == 0)
+            throw runtime_error ("the size of raw RGB files must be specified with --raw-size");
+        return to_bgr_image (map_rgb_image (fn, raw_rows, raw_cols));
+    }
+    return read_bgr_image (fn);
+}
+
+// the state of one image as it goes through the batch pipeline
+struct batch_state
+{
+    batch_job job;
+    bgr8_image_t input;
+    image_elements e;
+    bgr8_image_t output;
+    size_t rows;
+    size_t cols;
+    std::string error;
+};
+
+size_t run_batch (const batch_jobs &jobs, const of output_format, const en engine, const raster_cache_mode rc, const size_t min_pixels, const convex_uniform_tile &t, double scale, double angle, const size_t raw_rows, const size_t raw_cols)
+{
+    size_t failed = 0;
+    // decode the next image and encode the previous one while the current one is tiled
+    run_pipeline (jobs.size (),
+        [&] (size_t i)
+        {
+            batch_state s;
+            s.job = jobs[i];
+            try { s.input = decode_image (s.job.input, raw_rows, raw_cols); }
+            catch (const exception &e) { s.error = e.what (); }
+            return s;
+        },
+        [&] (batch_state &s)
+        {
+            if (!s.error.empty ())
+                return;
+            try
+            {
+                s.rows = s.input.rows ();
+                s.cols = s.input.cols ();
+                if (engine == en::labels)
+                {
+                    label_map_t l;
+                    s.e = get_image_elements (s.input, t, scale, angle, l);
+                    if (output_format == of::jpeg)
+                        s.output = render (l, s.e);
+                }
+                else if (engine == en::coverage)
+                {
+                    polygon_coverage c;
+                    s.e = get_image_elements (s.input, t, scale, angle, c);
+                    if (output_format == of::jpeg)
+                        s.output = render (s.cols, s.rows, c, s.e);
+                }
+                else if (engine == en::stream)
+                {
+                    s.e.m = get_streamed_colors (s.input, t, scale, angle);
+                    if (output_format == of::jpeg)
+                        s.output = render_streamed (s.cols, s.rows, t, scale, angle, s.e.m);
+                }
+                else
+                {
+                    s.e = get_image_elements (s.input, t, scale, angle, rc, min_pixels);
+                    if (output_format == of::jpeg)
+                        s.output = render (s.cols, s.rows, s.e);
+                }
+            }
+            catch (const exception &e) { s.error = e.what (); }
+            // the input is no longer needed
+            s.input.clear ();
+        },
+        [&] (batch_state &s)
+        {
+            if (s.error.empty ())
+            {
+                try
+                {
+                    switch (output_format)
+                    {
+                        default: throw runtime_error ("Unknown output type");
+                        case of::jpeg: write_image (s.job.output, s.output); break;
+                        case of::svg:
+                        case of::svg_instanced:
+                        if (engine == en::stream)
+                            write_streamed_svg (s.job.output, s.cols, s.rows, t, scale, angle, s.e.m, output_format == of::svg_instanced);
+                        else if (output_format == of::svg_instanced)
+                            write_instanced_svg (s.job.output, s.cols, s.rows, t, scale, angle, s.e);
+                        else
+                            write_svg (s.job.output, s.cols, s.rows, s.e);
+                        break;
+                        case of::scene:
+                        if (engine == en::stream)
+                            write_streamed_scene (s.job.output, s.cols, s.rows, t, scale, angle, s.e.m);
+                        else
+                            write_scene (s.job.output, s.cols, s.rows, t, scale, angle, s.e);
+                        break;
+                    }
+                }
+                catch (const exception &e) { s.error = e.what (); }
+            }
+            if (s.error.empty ())
+                clog << "wrote " << s.job.output << endl;
+            else
+            {
+                clog << "failed " << s.job.input << ": " << s.error << endl;
+                ++failed;
+            }
+        });
+    return failed;
+}
+
+// one set of parameters in a sweep
+struct variant
+{
+    unsigned tile_index;
+    double scale;
+    double angle;
+};
+
+template<typename T>
+std::vector<T> parse_list (const std::string &s)
+{
+    std::vector<T> v;
+    std::stringstream ss (s);
+    std::string item;
+    while (std::getline (ss, item, ','))
+    {
+        std::stringstream is (item);
+        T x;
+        if (!(is >> x))
+            throw runtime_error ("could not parse list '" + s + "'");
+        v.push_back (x);
+    }
+    return v;
+}
+
+image_elements get_variant_elements (const row_sums<3> &rs, const convex_uniform_tile &t, double scale, double angle, const raster_cache_mode rc)
+{
+    const size_t rows = rs.rows ();
+    const size_t cols = rs.cols ();
+    const double tw = scale * t.get_width ();
+    const double th = scale * t.get_height ();
+    const auto locs = get_window_tile_locations (rows, cols, point (cols / 2.0, rows / 2.0), tw, th, angle, t.is_triangular (), get_tile_extent (t.get_polygons (), scale, angle));
+    image_elements e;
+    e.p = get_intersecting_polygons (cols, rows, get_tiled_polygon_soup (locs, t.get_polygons (), scale, angle));
+    e.s = clip_scanlines (cols, rows, get_polygon_scanlines (e.p, get_prototype_polygons (t.get_polygons (), scale, angle), rc));
+    // the row sums are shared by all variants
+    e.m = get_colors (get_region_stats (rs, e.s));
+    return e;
+}
+
+void run_sweep (const bgr8_image_t &img, const std::string &input_fn, const std::string &output, const of output_format, const raster_cache_mode rc, const tile_list &tl, const std::vector<variant> &v, const size_t cell_width)
+{
+    // write one file per variant to a directory, or draw them all on one contact sheet
+    const bool to_dir = is_directory (output);
+    if (!to_dir && output_format != of::jpeg)
+        throw runtime_error ("contact sheets must be raster images, specify an output directory for svg files");
+    const size_t n = v.size ();
+    const size_t grid_cols = ::ceil (::sqrt (n));
+    const size_t grid_rows = (n + grid_cols - 1) / grid_cols;
+    const size_t cw = std::min (cell_width, img.cols ());
+    const size_t ch = std::max (size_t (1), static_cast<size_t> (::round (static_cast<double> (img.rows ()) * cw / img.cols ())));
+    const size_t gap = 2;
+    bgr8_image_t sheet;
+    if (!to_dir)
+    {
+        sheet = create_bgr_image (grid_rows * (ch + gap) + gap, grid_cols * (cw + gap) + gap);
+        sheet.assign (255);
+    }
+    std::vector<std::string> fns (n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        std::stringstream fn;
+        fn << output << (output.back () == '/' ? "" : "/") << get_stem (input_fn)
+            << "_t" << v[i].tile_index << "_s" << v[i].scale << "_a" << v[i].angle
+            << get_output_extension (output_format);
+        fns[i] = fn.str ();
+    }
+    clog << "computing row sums" << endl;
+    const row_sums<3> rs (img);
+    clog << "rendering " << n << " variants" << endl;
+    std::string error;
+    // render the variants in parallel, each one on a single thread
+#pragma omp parallel for schedule (dynamic)
+    for (size_t i = 0; i < n; ++i)
+    {
+        try
+        {
+            const image_elements e = get_variant_elements (rs, tl[v[i].tile_index], v[i].scale, v[i].angle, rc);
+            if (output_format == of::svg)
+            {
+                write_svg (fns[i], img.cols (), img.rows (), e);
+                continue;
+            }
+            if (output_format == of::svg_instanced)
+            {
+                write_instanced_svg (fns[i], img.cols (), img.rows (), tl[v[i].tile_index], v[i].scale, v[i].angle, e);
+                continue;
+            }
+            if (output_format == of::scene)
+            {
+                write_scene (fns[i], img.cols (), img.rows (), tl[v[i].tile_index], v[i].scale, v[i].angle, e);
+                continue;
+            }
+            const bgr8_image_t r = render (img.cols (), img.rows (), e);
+            if (to_dir)
+            {
+                write_image (fns[i], r);
+                continue;
+            }
+            // each cell is in its own part of the sheet
+            const bgr8_image_t c = resize (r, ch, cw);
+            const size_t y0 = gap + (i / grid_cols) * (ch + gap);
+            const size_t x0 = gap + (i % grid_cols) * (cw + gap);
+            for (size_t y = 0; y < ch; ++y)
+            {
+                const unsigned char *src = &c[0] + y * cw * 3;
+                std::copy (src, src + cw * 3, &sheet[0] + ((y0 + y) * sheet.cols () + x0) * 3);
+            }
+        }
+        catch (const exception &e)
+        {
+#pragma omp critical
+            error = e.what ();
+        }
+    }
+    if (!error.empty ())
+        throw runtime_error (error);
+    for (size_t i = 0; i < n; ++i)
+    {
+        clog << "[" << i << "] " << tl[v[i].tile_index].get_name () << " scale " << v[i].scale << " angle " << v[i].angle;
+        if (to_dir)
+            clog << " " << fns[i] << endl;
+        else
+            clog << " row " << i / grid_cols << " col " << i % grid_cols << endl;
+    }
+    if (!to_dir)
+    {
+        clog << "writing to " << output << endl;
+        write_image (output, sheet);
+    }
 }
 
 int main (int argc, char **argv)
 {
     try
     {
-        // output file type
-        enum class of { svg, jpeg } output_format = of::jpeg;
+        of output_format = of::jpeg;
+        en engine = en::scanlines;
+        // the exact cache gives the same output as rasterizing every polygon
+        raster_cache_mode rc = raster_cache_mode::exact;
+        // 0 means take means from every pixel, otherwise from a pyramid level that keeps this many pixels per polygon
+        size_t min_pixels = 0;
         // show list of tiles
         bool list = false;
         // other options
         unsigned tile_index = 10;
         double scale = 16.0;
         double angle = 10.0;
+        // 0 means use all available cores
+        unsigned threads = 0;
+        // 0 means process the whole image at once
+        size_t band_rows = 0;
+        // dimensions of raw RGB input files
+        size_t raw_rows = 0;
+        size_t raw_cols = 0;
+        // size of rendered scene files, 0 means their own size
+        size_t render_rows = 0;
+        size_t render_cols = 0;
+        // manifest or directory of inputs
+        string batch;
+        // lists of parameters to sweep
+        string tile_list_arg;
+        string scale_list_arg;
+        string angle_list_arg;
+        size_t cell_width = 512;
         string input_fn;
         string output_fn;
 
@@ -124,14 +636,28 @@ int main (int argc, char **argv)
                 {"help", no_argument, 0,  'h' },
                 {"jpeg", no_argument, 0,  'j' },
                 {"svg",  no_argument, 0,  'v' },
+                {"instanced-svg",  no_argument, 0,  'i' },
+                {"scene",  no_argument, 0,  'x' },
                 {"list", no_argument, 0,  'l' },
                 {"tile-index", required_argument, 0,  't' },
                 {"scale", required_argument, 0,  's' },
                 {"angle", required_argument, 0,  'a' },
+                {"threads", required_argument, 0,  'n' },
+                {"engine", required_argument, 0,  'e' },
+                {"band-rows", required_argument, 0,  'b' },
+                {"raw-size", required_argument, 0,  'r' },
+                {"batch", required_argument, 0,  'B' },
+                {"tiles", required_argument, 0,  'T' },
+                {"scales", required_argument, 0,  'S' },
+                {"angles", required_argument, 0,  'A' },
+                {"cell-width", required_argument, 0,  'w' },
+                {"raster-cache", required_argument, 0,  'c' },
+                {"pyramid", required_argument, 0,  'p' },
+                {"render-size", required_argument, 0,  'R' },
                 {0,      0,           0,  0 }
             };
 
-            int c = getopt_long(argc, argv, "hjvlt:s:a:", long_options, &option_index);
+            int c = getopt_long(argc, argv, "hjvixlt:s:a:n:e:b:r:B:T:S:A:w:c:p:R:", long_options, &option_index);
             if (c == -1)
                 break;
 
@@ -157,9 +683,71 @@ int main (int argc, char **argv)
                 case 'l': list = true; break;
                 case 'j': output_format = of::jpeg; break;
                 case 'v': output_format = of::svg; break;
+                case 'i': output_format = of::svg_instanced; break;
+                case 'x': output_format = of::scene; break;
                 case 't': tile_index = atoi (optarg); break;
                 case 's': scale = atof (optarg); break;
                 case 'a': angle = atof (optarg); break;
+                case 'n':
+                {
+                    // %u would wrap a negative number around
+                    if (strchr (optarg, '-') != nullptr || sscanf (optarg, "%u", &threads) != 1)
+                        throw runtime_error ("the number of threads must be a number, 0 means use all cores");
+                }
+                break;
+                case 'b':
+                {
+                    // %zu would wrap a negative number around
+                    if (strchr (optarg, '-') != nullptr || sscanf (optarg, "%zu", &band_rows) != 1 || band_rows == 0)
+                        throw runtime_error ("the band rows must be a positive number");
+                }
+                break;
+                case 'B': batch = optarg; break;
+                case 'T': tile_list_arg = optarg; break;
+                case 'S': scale_list_arg = optarg; break;
+                case 'A': angle_list_arg = optarg; break;
+                case 'w': cell_width = atoi (optarg); break;
+                case 'p': min_pixels = atoi (optarg); break;
+                case 'r':
+                {
+                    if (sscanf (optarg, "%zux%zu", &raw_cols, &raw_rows) != 2)
+                        throw runtime_error ("the raw size must be given as <width>x<height>");
+                }
+                break;
+                case 'R':
+                {
+                    if (sscanf (optarg, "%zux%zu", &render_cols, &render_rows) != 2 || render_cols == 0 || render_rows == 0)
+                        throw runtime_error ("the render size must be given as <width>x<height>");
+                }
+                break;
+                case 'c':
+                {
+                    const string name (optarg);
+                    if (name == "none")
+                        rc = raster_cache_mode::none;
+                    else if (name == "exact")
+                        rc = raster_cache_mode::exact;
+                    else if (name == "quantized")
+                        rc = raster_cache_mode::quantized;
+                    else
+                        throw runtime_error ("unknown raster cache mode, use 'none', 'exact' or 'quantized'");
+                }
+                break;
+                case 'e':
+                {
+                    const string name (optarg);
+                    if (name == "scanlines")
+                        engine = en::scanlines;
+                    else if (name == "labels")
+                        engine = en::labels;
+                    else if (name == "stream")
+                        engine = en::stream;
+                    else if (name == "coverage")
+                        engine = en::coverage;
+                    else
+                        throw runtime_error ("unknown engine, use 'scanlines', 'labels', 'stream' or 'coverage'");
+                }
+                break;
             }
         }
 
@@ -181,6 +769,39 @@ int main (int argc, char **argv)
             case of::svg:
             clog << "output_format: " << "svg" << endl;
             break;
+            case of::svg_instanced:
+            clog << "output_format: " << "instanced svg" << endl;
+            break;
+            case of::scene:
+            clog << "output_format: " << "scene" << endl;
+            break;
+        }
+
+        if (min_pixels != 0 && engine != en::scanlines)
+            throw runtime_error ("pyramid means are only supported by the scanlines engine");
+
+        if (!batch.empty ())
+        {
+            if (tile_index >= tl.size ())
+                throw runtime_error ("the tile index is invalid");
+            if (band_rows != 0)
+                throw runtime_error ("band processing is not supported in batch mode");
+            if (optind >= argc)
+                throw runtime_error ("no output directory specified");
+            const string output_dir = argv[optind];
+            const batch_jobs jobs = get_batch_jobs (batch, output_dir, get_output_extension (output_format) + 1);
+            clog << jobs.size () << " images" << endl;
+            clog << "tile " << tl[tile_index].get_name () << endl;
+            clog << "scale " << scale << endl;
+            clog << "angle " << angle << endl;
+            set_thread_count (threads);
+            const size_t failed = run_batch (jobs, output_format, engine, rc, min_pixels, tl[tile_index], scale, angle, raw_rows, raw_cols);
+            if (failed != 0)
+            {
+                clog << failed << " of " << jobs.size () << " images failed" << endl;
+                return -1;
+            }
+            return 0;
         }
 
         if (optind < argc)
@@ -195,24 +816,118 @@ int main (int argc, char **argv)
         else
             throw runtime_error ("no output filename specified");
 
+        if (get_extension (input_fn) == "scene")
+        {
+            // re-render a stored tiling
+            if (output_format != of::jpeg)
+                throw runtime_error ("scene files can only be rendered to raster images");
+            clog << "reading " << input_fn << endl;
+            const scene s (input_fn);
+            const size_t rows = render_rows != 0 ? render_rows : s.get_header ().rows;
+            const size_t cols = render_cols != 0 ? render_cols : s.get_header ().cols;
+            clog << s.size () << " instances" << endl;
+            clog << "width " << cols << endl;
+            clog << "height " << rows << endl;
+            clog << "writing to " << output_fn << endl;
+            if (is_row_writer_filename (output_fn))
+            {
+                // place and rasterize each instance when its first row is painted, so there is never a full image
+                scene_row_painter p (s, rows, cols);
+                write_rows (output_fn, rows, cols, [&] (unsigned char *dst) { p.paint (dst); });
+                return 0;
+            }
+            bgr8_image_t img = create_bgr_image (rows, cols);
+            render (s, img);
+            write_image (output_fn, img);
+            return 0;
+        }
+
+        if (!tile_list_arg.empty () || !scale_list_arg.empty () || !angle_list_arg.empty ())
+        {
+            // every combination of the listed parameters
+            const auto tiles = tile_list_arg.empty () ? vector<unsigned> (1, tile_index) : parse_list<unsigned> (tile_list_arg);
+            const auto scales = scale_list_arg.empty () ? vector<double> (1, scale) : parse_list<double> (scale_list_arg);
+            const auto angles = angle_list_arg.empty () ? vector<double> (1, angle) : parse_list<double> (angle_list_arg);
+            vector<variant> v;
+            for (auto i : tiles)
+            {
+                if (i >= tl.size ())
+                    throw runtime_error ("the tile index is invalid");
+                for (auto j : scales)
+                    for (auto k : angles)
+                        v.push_back (variant { i, j, k });
+            }
+            if (v.empty () || cell_width == 0)
+                throw runtime_error ("nothing to sweep");
+            // the cost of the row sums does not depend on the scale
+            if (min_pixels != 0)
+                throw runtime_error ("pyramid means are not needed in sweeps, which use row sums");
+            if (engine != en::scanlines)
+                throw runtime_error ("sweeps only support the scanlines engine");
+            if (band_rows != 0)
+                throw runtime_error ("band processing is not supported in sweeps");
+            set_thread_count (threads);
+            clog << "reading " << input_fn << endl;
+            // decode once for all variants
+            const bgr8_image_t img = decode_image (input_fn, raw_rows, raw_cols);
+            run_sweep (img, input_fn, output_fn, output_format, rc, tl, v, cell_width);
+            return 0;
+        }
+
         clog << "tile " << tl[tile_index].get_name () << endl;
         clog << "scale " << scale << endl;
         clog << "angle " << angle << endl;
+        set_thread_count (threads);
         clog << "reading " << input_fn << endl;
 
         if (tile_index >= tl.size ())
             throw runtime_error ("the tile index is invalid");
 
-        rgb8_image_t img = read_image (input_fn);
-        clog << "width " << img.cols () << endl;
-        clog << "height " << img.rows () << endl;
-        const image_elements e = get_image_elements (img, tl[tile_index], scale, angle);
-        clog << "writing to " << output_fn << endl;
-        switch (output_format)
+        if (band_rows != 0)
         {
-            default: throw runtime_error ("Unknown output type");
-            case of::jpeg: write_jpg (output_fn, img.cols (), img.rows (), e); break;
-            case of::svg: write_svg (output_fn, img.cols (), img.rows (), e); break;
+            // bounded memory mode
+            if (output_format != of::jpeg)
+                throw runtime_error ("band processing only supports raster output");
+            if (min_pixels != 0)
+                throw runtime_error ("pyramid means are not supported by band processing");
+            if (engine != en::scanlines)
+                throw runtime_error ("band processing only supports the scanlines engine");
+            clog << "band rows " << band_rows << endl;
+            clog << "writing to " << output_fn << endl;
+            if (is_ppm_filename (input_fn))
+            {
+                // only PPM and PAM files can be decoded a band at a time
+                ppm_band_reader src (input_fn);
+                write_bands (src, output_fn, tl[tile_index], scale, angle, band_rows);
+            }
+            else
+            {
+                const rgb8_image_t img = read_image (input_fn);
+                image_band_reader src (img);
+                write_bands (src, output_fn, tl[tile_index], scale, angle, band_rows);
+            }
+            return 0;
+        }
+
+        if (is_ppm_filename (input_fn))
+        {
+            // map the file, no decoding or copying
+            const mmap_rgb8_image_t img = map_ppm_image (input_fn);
+            write_tiled_image (img, output_fn, output_format, engine, rc, min_pixels, tl[tile_index], scale, angle);
+        }
+        else if (get_extension (input_fn) == "rgb")
+        {
+            // raw interlaced RGB
+            if (raw_rows == 0 || raw_cols == 0)
+                throw runtime_error ("the size of raw RGB files must be specified with --raw-size");
+            const mmap_rgb8_image_t img = map_rgb_image (input_fn, raw_rows, raw_cols);
+            write_tiled_image (img, output_fn, output_format, engine, rc, min_pixels, tl[tile_index], scale, angle);
+        }
+        else
+        {
+            // use the decoded pixels as they are, no conversion or copying
+            const bgr8_image_t img = read_bgr_image (input_fn);
+            write_tiled_image (img, output_fn, output_format, engine, rc, min_pixels, tl[tile_index], scale, angle);
         }
 
         return 0;
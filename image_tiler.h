@@ -7,10 +7,23 @@
 #ifndef IMAGE_TILER_H
 #define IMAGE_TILER_H
 
+#include "band_tiler.h"
+#include "batch.h"
+#include "coverage.h"
 #include "geometry.h"
 #include "graphics.h"
 #include "image.h"
+#include "image_elements.h"
+#include "label_map.h"
+#include "mmap_image.h"
 #include "opencv_utils.h"
+#include "pipeline.h"
+#include "ppm.h"
+#include "row_writer.h"
+#include "scene.h"
+#include "stats.h"
+#include "svg.h"
+#include "tile_visitor.h"
 #include "tiler.h"
 #include "tiles.h"
 #include "utils.h"
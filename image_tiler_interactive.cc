@@ -4,8 +4,10 @@
 /// @version 1.0
 /// @date 2014-03-03
 
+#include "async_preview.h"
 #include "graphics.h"
 #include "image.h"
+#include "image_elements.h"
 #include "opencv_utils.h"
 #include "tiler.h"
 #include "tiles.h"
@@ -17,27 +19,6 @@ const char *usage = "pgm <image>";
 using namespace image_tiler;
 using namespace std;
 
-struct image_element
-{
-    polygon p;
-    scanlines s;
-    rgb8_pixel_t m;
-};
-
-typedef std::vector<image_element> image_elements;
-
-template<typename T>
-T draw_polys (const T &img, const polygons &all_polys, const rgb8_pixel_t &p)
-{
-    T tmp (img);
-
-    // draw polygons
-    for (auto i : all_polys)
-        draw_lines (tmp, i, p);
-
-    return tmp;
-}
-
 int main (int argc, char **argv)
 {
     try
@@ -47,7 +28,8 @@ int main (int argc, char **argv)
 
         const string fn (argv[1]);
 
-        rgb8_image_t original = read_image (fn);
+        // keep everything in OpenCV's channel order so that frames can be shown without converting them
+        bgr8_image_t original = read_bgr_image (fn);
 
         clog << "input file: " << fn << endl;
 
@@ -59,91 +41,63 @@ int main (int argc, char **argv)
         tile_list tl = create_tile_list ();
 
         const char *window_name = "Image Tiler";
-        int tile_number = 10;
-        bool outline = false;
-        int transparency = 0;
-        double scale = 30.0;
-        double angle = 0.0;
-        double xoffset = 0;
-        double yoffset = 0;
-        bool randomize = false;
+        // frames are rendered in the background, so the window keeps up with the keyboard
+        async_preview<bgr8_image_t> pv (original, tl);
+        preview_params p;
+        pv.request (p);
+        // the frame on the screen
+        bgr8_image_t img;
         bool done = false;
 
-        while (!done)
+        // update the parameters, and return true if they changed
+        auto handle_key = [&] (const char ch)
         {
-            const convex_uniform_tile p = tl[tile_number];
-            const double tw = scale * p.get_width ();
-            const double th = scale * p.get_height ();
-            const auto locs = get_tile_locations (h, w, point (xoffset + w / 2.0, yoffset + h / 2.0), tw, th, angle, p.is_triangular ());
-            const auto all_polys = get_tiled_polygons (locs, p.get_polygons (), scale, angle);
-            const auto window_polys = get_intersecting_polygons (w, h, all_polys);
-            const auto ps = clip_scanlines (w, h, get_polygon_scanlines (window_polys));
-
-            // get mean pixel values
-            std::vector<rgb8_pixel_t> m (ps.size ());
-            for (size_t i = 0; i < m.size (); ++i)
-                for (auto j : { 0, 1, 2 })
-                    m[i][j] = get_mean (original, ps[i], j);
-            image_elements e (m.size ());
-            for (size_t i = 0; i < m.size (); ++i)
-            {
-                e[i].p = window_polys[i];
-                e[i].s = ps[i];
-                e[i].m = m[i];
-            }
-
-            // Randomize tile colors
-            if (randomize)
-            {
-                // shuffle the colors
-                for (auto element : e)
-                {
-                    size_t index = rand () % e.size ();
-                    swap (element.m, e[index].m);
-                }
-            }
-
-            rgb8_image_t img (original);
-            for (size_t i = 0; i < e.size (); ++i)
-                for (auto j : {0, 1, 2})
-                    fill (img, e[i].s, e[i].m[j], j);
-
-            for (size_t i = 0; i < img.size (); ++i)
-            {
-                img[i] = round (original[i] * transparency / 100.0 + img[i] * (1.0 - transparency / 100.0));
-            }
-
-            if (outline)
-                img = draw_polys (img, all_polys, {212, 212, 212});
-
-            cv::imshow (window_name, image_to_mat (img));
-            char ch = cv::waitKey (0);
-
             switch (ch)
             {
+                default: return false;
                 case 'q':
                 case 27: done = true;
-                case 32: { tile_number = (tile_number + 1) % tl.size (); } break;
-                case 'l': { outline = !outline; } break;
-                case 'r': { randomize = !randomize; } break;
-                case 't': { transparency += 1; transparency %= 100; } break;
-                case 'T': { transparency += 10; transparency %= 100; } break;
-                case 'A': { angle -= 1; } break;
-                case 'a': { angle += 1; } break;
-                case 'S': { scale = scale > 20 ? scale - 10 : 10; } break;
-                case 's': { scale += 10; } break;
-                case 'X': { xoffset -= 1; } break;
-                case 'x': { xoffset += 1; } break;
-                case 'Y': { yoffset -= 1; } break;
-                case 'y': { yoffset += 1; } break;
+                case 32: { p.tile_index = (p.tile_index + 1) % tl.size (); } break;
+                case 'l': { p.outline = !p.outline; } break;
+                case 'r': { p.randomize = !p.randomize; } break;
+                // draft means, from a pyramid
+                case 'p': { p.min_pixels = p.min_pixels == 0 ? 256 : 0; } break;
+                case 't': { p.transparency += 1; p.transparency %= 100; } break;
+                case 'T': { p.transparency += 10; p.transparency %= 100; } break;
+                case 'A': { p.angle -= 1; } break;
+                case 'a': { p.angle += 1; } break;
+                case 'S': { p.scale = p.scale > 20 ? p.scale - 10 : 10; } break;
+                case 's': { p.scale += 10; } break;
+                case 'X': { p.xoffset -= 1; } break;
+                case 'x': { p.xoffset += 1; } break;
+                case 'Y': { p.yoffset -= 1; } break;
+                case 'y': { p.yoffset += 1; } break;
                 case 'w':
                 {
+                    if (img.empty ())
+                        return false;
                     const string output_fn = "out.png";
                     clog << "writing to " << output_fn << endl;
                     write_image (output_fn, img);
                 }
-                break;
+                return false;
             }
+            return true;
+        };
+
+        while (!done)
+        {
+            size_t generation;
+            if (pv.get_frame (img, generation))
+                cv::imshow (window_name, image_to_mat (img));
+            // poll, so that finished frames are shown while no keys are pressed
+            int ch = cv::waitKey (30);
+            // coalesce keys that are already waiting, such as auto repeats, into one request
+            bool changed = false;
+            for (; ch != -1 && !done; ch = cv::waitKey (1))
+                changed = handle_key (ch) || changed;
+            if (changed && !done)
+                pv.request (p);
         }
         cv::destroyWindow (window_name);
         return 0;
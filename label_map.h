@@ -0,0 +1,154 @@
+/// @file label_map.h
+/// @brief per pixel polygon labels
+/// @author Jeff Perry <jeffsp@gmail.com>
+/// @version 1.0
+/// @date 2014-07-27
+
+#ifndef LABEL_MAP_H
+#define LABEL_MAP_H
+
+#include "geometry.h"
+#include "graphics.h"
+#include "image.h"
+#include "stats.h"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace image_tiler
+{
+
+/// @brief each pixel holds the index of the polygon that covers it
+typedef image<uint32_t,1> label_map_t;
+
+/// @brief the label of pixels that are not covered by any polygon
+const uint32_t no_label = std::numeric_limits<uint32_t>::max ();
+
+/// @brief rasterize polygons into a label map
+///
+/// @param rows rows in the map
+/// @param cols cols in the map
+/// @param p the polygons, or a polygon soup
+///
+/// @return the label map
+///
+/// Where polygons overlap, the one with the highest index wins, just like painting them in order.
+template<typename PS>
+label_map_t get_label_map (const size_t rows, const size_t cols, const PS &p)
+{
+    assert (p.size () < no_label);
+    label_map_t l (rows, cols, no_label);
+    const rect window (0, 0, cols, rows);
+    scanlines s;
+    for (size_t i = 0; i < p.size (); ++i)
+    {
+        s.clear ();
+        get_convex_polygon_scanlines (p[i], s);
+        for (const auto &j : clip (s, window))
+        {
+            uint32_t *dst = &l (j.y, j.x);
+            std::fill (dst, dst + j.len, static_cast<uint32_t> (i));
+        }
+    }
+    return l;
+}
+
+/// @brief get the statistics of each labeled region
+///
+/// @param img the image
+/// @param l the label map
+/// @param n the number of labels
+///
+/// @return the count and mean of each region
+///
+/// The image and the label map are both read once, front to back.
+template<typename T,size_t CHANNELS,typename Cont,typename Order>
+std::vector<region_stats<CHANNELS>> get_label_stats (const image<T,CHANNELS,Cont,Order> &img, const label_map_t &l, const size_t n)
+{
+    assert (img.rows () == l.rows ());
+    assert (img.cols () == l.cols ());
+    std::vector<uint64_t> sums (n * CHANNELS);
+    std::vector<size_t> counts (n);
+    std::vector<region_stats<CHANNELS>> r (n);
+    if (l.empty ())
+        return r;
+    const T *src = &img[0];
+    for (const auto i : l)
+    {
+        if (i != no_label)
+        {
+            uint64_t *sum = &sums[i * CHANNELS];
+            for (size_t k = 0; k < CHANNELS; ++k)
+                sum[k] += src[k];
+            ++counts[i];
+        }
+        src += CHANNELS;
+    }
+    for (size_t i = 0; i < n; ++i)
+    {
+        r[i].count = counts[i];
+        if (counts[i] == 0)
+            continue;
+        for (size_t k = 0; k < CHANNELS; ++k)
+            r[i].mean[k] = ::round (static_cast<double> (sums[i * CHANNELS + Order::channel (k)]) / counts[i]);
+    }
+    return r;
+}
+
+/// @brief paint each labeled pixel with the color of its label
+///
+/// @param l the label map
+/// @param m one color for each label
+/// @param img the image to paint
+///
+/// Unlabeled pixels are left alone.
+template<typename T,typename P>
+void paint_label_map (const label_map_t &l, const std::vector<P> &m, T &img)
+{
+    assert (img.rows () == l.rows ());
+    assert (img.cols () == l.cols ());
+#pragma omp parallel for
+    for (size_t r = 0; r < l.rows (); ++r)
+    {
+        const uint32_t *src = &l (r, 0);
+        for (size_t c = 0; c < l.cols (); ++c)
+        {
+            if (src[c] == no_label)
+                continue;
+            const P &p = m[src[c]];
+            for (size_t k = 0; k < img.channels (); ++k)
+                img (r, c, k) = p[k];
+        }
+    }
+}
+
+/// @brief paint one row of the regions of a label map with their colors
+///
+/// @param l the label map
+/// @param m the color of each label
+/// @param r the row
+/// @param dst cols interlaced RGB pixels
+///
+/// Unlabeled pixels are black.
+template<typename P>
+void paint_label_map_row (const label_map_t &l, const std::vector<P> &m, const size_t r, unsigned char *dst)
+{
+    const uint32_t *src = &l (r, 0);
+    for (size_t c = 0; c < l.cols (); ++c, dst += 3)
+    {
+        if (src[c] == no_label)
+        {
+            dst[0] = dst[1] = dst[2] = 0;
+            continue;
+        }
+        const P &p = m[src[c]];
+        dst[0] = p[0];
+        dst[1] = p[1];
+        dst[2] = p[2];
+    }
+}
+
+} // namespace image_tiler
+
+#endif // LABEL_MAP_H
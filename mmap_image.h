@@ -0,0 +1,110 @@
+/// @file mmap_image.h
+/// @brief memory mapped images
+/// @author Jeff Perry <jeffsp@gmail.com>
+/// @version 1.0
+/// @date 2014-07-27
+
+#ifndef MMAP_IMAGE_H
+#define MMAP_IMAGE_H
+
+#include "image.h"
+#include "ppm.h"
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace image_tiler
+{
+
+/// @brief a region of memory that is unmapped when it is destroyed
+class mmap_region
+{
+    public:
+    mmap_region (void *addr, size_t len)
+        : addr (addr), len (len)
+    { }
+    ~mmap_region ()
+    {
+        if (addr != MAP_FAILED)
+            munmap (addr, len);
+    }
+    mmap_region (const mmap_region &) = delete;
+    mmap_region &operator= (const mmap_region &) = delete;
+    void *get () const { return addr; }
+    private:
+    void *addr;
+    size_t len;
+};
+
+/// @brief map part of a file
+///
+/// @param fn file name
+/// @param offset byte offset of the first element in the file
+/// @param n number of elements
+///
+/// @return a container that refers to the mapped memory
+///
+/// The mapping is private, so elements may be written without changing the file.  Pages are only read from the file
+/// when they are touched.
+template<typename T>
+buffer_container<T> map_file (const std::string &fn, const size_t offset, const size_t n)
+{
+    const int fd = open (fn.c_str (), O_RDONLY);
+    if (fd == -1)
+        throw std::runtime_error ("could not open file for reading");
+    struct stat st;
+    if (fstat (fd, &st) == -1 || static_cast<size_t> (st.st_size) < offset + n * sizeof (T))
+    {
+        close (fd);
+        throw std::runtime_error ("the file is too small");
+    }
+    // map the whole file because the offset may not be page aligned
+    const size_t len = offset + n * sizeof (T);
+    void *addr = mmap (nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close (fd);
+    if (addr == MAP_FAILED)
+        throw std::runtime_error ("could not map file");
+    const std::shared_ptr<mmap_region> region = std::make_shared<mmap_region> (addr, len);
+    return buffer_container<T> (reinterpret_cast<T *> (static_cast<char *> (addr) + offset), n, region);
+}
+
+/// @brief interlaced RGB, mapped from a file
+typedef image<unsigned char,3,buffer_container<unsigned char>> mmap_rgb8_image_t;
+
+/// @brief map raw, interlaced 8 bit RGB data
+///
+/// @param fn file name
+/// @param rows rows in the image
+/// @param cols cols in the image
+/// @param offset byte offset of the first pixel
+///
+/// @return an image that aliases the mapped file
+mmap_rgb8_image_t map_rgb_image (const std::string &fn, const size_t rows, const size_t cols, const size_t offset = 0)
+{
+    return mmap_rgb8_image_t (rows, cols, map_file<unsigned char> (fn, offset, rows * cols * 3));
+}
+
+/// @brief map a binary PPM or PAM file without decoding or copying it
+///
+/// @param fn file name
+///
+/// @return an image that aliases the mapped file
+mmap_rgb8_image_t map_ppm_image (const std::string &fn)
+{
+    std::ifstream ifs (fn.c_str (), std::ios::binary);
+    if (!ifs)
+        throw std::runtime_error ("could not open file for reading");
+    const ppm_header h = read_ppm_header (ifs);
+    return map_rgb_image (fn, h.rows, h.cols, h.offset);
+}
+
+} // namespace image_tiler
+
+#endif // MMAP_IMAGE_H
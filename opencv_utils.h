@@ -8,11 +8,13 @@
 #define OPENCV_UTILS_H
 
 #include <cmath>
+#include <memory>
 #include <stdexcept>
 #include <iostream>
 #include <sys/time.h>
 
 #include "image.h"
+#include "swizzle.h"
 
 #include "opencv2/imgproc/imgproc.hpp"
 #include "opencv2/highgui/highgui.hpp"
@@ -76,45 +78,86 @@ keys get_key ()
     }
 }
 
+/// @brief interlaced BGR, stored in the same layout as an OpenCV CV_8UC3 matrix
+typedef image<unsigned char,3,buffer_container<unsigned char>,bgr_order> bgr8_image_t;
+
+/// @brief use the pixels of an OpenCV matrix as an image without copying them
+///
+/// @param m an 8 bit, 3 channel, continuous matrix
+///
+/// @return an image that shares its pixels with m
+///
+/// The image holds a reference to the matrix data, so it remains valid after m is destroyed.
+bgr8_image_t mat_to_bgr_image (const cv::Mat &m)
+{
+    if (m.depth () != CV_8U || m.channels () != 3)
+        throw std::runtime_error ("image is not 8 bit RGB");
+    if (!m.isContinuous ())
+        throw std::runtime_error ("image rows are not continuous");
+    const std::shared_ptr<cv::Mat> owner = std::make_shared<cv::Mat> (m);
+    buffer_container<unsigned char> c (owner->data, m.rows * m.cols * 3, owner);
+    return bgr8_image_t (m.rows, m.cols, std::move (c));
+}
+
+/// @brief allocate an image whose pixels can be shown or written by OpenCV without copying them
+bgr8_image_t create_bgr_image (const size_t rows, const size_t cols)
+{
+    return mat_to_bgr_image (cv::Mat (rows, cols, CV_8UC3, cv::Scalar (0, 0, 0)));
+}
+
+/// @brief get an OpenCV matrix header that refers to the pixels of an image without copying them
+///
+/// The matrix is only valid for as long as the image is.  It is read-only, the image's pixels must not be changed
+/// through it.
+const cv::Mat image_to_mat (const bgr8_image_t &img)
+{
+    return cv::Mat (img.rows (), img.cols (), CV_8UC3, const_cast<unsigned char *> (img.container ().data ()));
+}
+
 cv::Mat image_to_mat (const rgb8_image_t &img)
 {
-    cv::Mat m (img.rows (), img.cols (), CV_8UC3, cv::Scalar (256, 256, 256));
+    cv::Mat m (img.rows (), img.cols (), CV_8UC3);
+    // Mat is BGR, not RGB
     for (size_t i = 0; i < img.rows (); ++i)
-    {
-        for (size_t j = 0; j < img.cols (); ++j)
-        {
-            // Mat is BGR, not RGB
-            m.at<cv::Vec3b> (i, j)[2] = img (i, j, 0);
-            m.at<cv::Vec3b> (i, j)[1] = img (i, j, 1);
-            m.at<cv::Vec3b> (i, j)[0] = img (i, j, 2);
-        }
-    }
+        swap_rb (&img[img.index (i, 0, 0)], m.ptr<unsigned char> (i), img.cols ());
     return m;
 }
 
 rgb8_image_t mat_to_image (const cv::Mat &m)
 {
+    if (m.depth () != CV_8U || m.channels () != 3)
+        throw std::runtime_error ("image is not 8 bit RGB");
     rgb8_image_t img (m.rows, m.cols);
+    // Mat is BGR, not RGB
     for (size_t i = 0; i < img.rows (); ++i)
-    {
-        for (size_t j = 0; j < img.cols (); ++j)
-        {
-            // Mat is BGR, not RGB
-            img (i, j, 0) = m.at<cv::Vec3b> (i, j)[2];
-            img (i, j, 1) = m.at<cv::Vec3b> (i, j)[1];
-            img (i, j, 2) = m.at<cv::Vec3b> (i, j)[0];
-        }
-    }
+        swap_rb (m.ptr<unsigned char> (i), &img[img.index (i, 0, 0)], img.cols ());
     return img;
 }
 
+/// @brief copy an RGB image, such as a memory mapped file, into OpenCV's channel order
+template<typename C>
+bgr8_image_t to_bgr_image (const image<unsigned char,3,C,rgb_order> &img)
+{
+    bgr8_image_t b = create_bgr_image (img.rows (), img.cols ());
+    if (!img.empty ())
+        swap_rb (&img[0], &b[0], img.rows () * img.cols ());
+    return b;
+}
+
 rgb8_image_t resize (const rgb8_image_t &img, size_t rows, size_t cols)
 {
-    cv::Mat m = image_to_mat (img);
-    cv::resize (m, m, cv::Size (cols, rows));
+    cv::Mat m;
+    cv::resize (image_to_mat (img), m, cv::Size (cols, rows));
     return mat_to_image (m);
 }
 
+bgr8_image_t resize (const bgr8_image_t &img, size_t rows, size_t cols)
+{
+    cv::Mat m;
+    cv::resize (image_to_mat (img), m, cv::Size (cols, rows));
+    return mat_to_bgr_image (m);
+}
+
 rgb8_image_t read_image (const std::string &fn)
 {
     cv::Mat m = cv::imread (fn);
@@ -123,12 +166,23 @@ rgb8_image_t read_image (const std::string &fn)
     return mat_to_image (m);
 }
 
+/// @brief read an image in OpenCV's native channel order, without converting it
+bgr8_image_t read_bgr_image (const std::string &fn)
+{
+    cv::Mat m = cv::imread (fn);
+    if (m.empty ())
+        throw std::runtime_error ("could not read image");
+    return mat_to_bgr_image (m);
+}
+
 void write_image (const std::string &fn, const rgb8_image_t &img)
 {
-    cv::Mat m = image_to_mat (img);
-    if (m.depth () != CV_8U || m.channels () != 3)
-        throw std::runtime_error ("image is not 8 bit RGB");
-    cv::imwrite (fn, m);
+    cv::imwrite (fn, image_to_mat (img));
+}
+
+void write_image (const std::string &fn, const bgr8_image_t &img)
+{
+    cv::imwrite (fn, image_to_mat (img));
 }
 
 }
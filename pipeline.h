@@ -0,0 +1,161 @@
+/// @file pipeline.h
+/// @brief run a sequence of jobs through concurrent stages
+/// @author Jeff Perry <jeffsp@gmail.com>
+/// @version 1.0
+/// @date 2014-07-27
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <cassert>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace image_tiler
+{
+
+/// @brief a first in, first out queue that blocks producers when it is full and consumers when it is empty
+template<typename T>
+class bounded_queue
+{
+    public:
+    explicit bounded_queue (const size_t capacity)
+        : capacity (capacity), closed (false)
+    {
+        assert (capacity != 0);
+    }
+    /// @brief add an item, waiting for room
+    ///
+    /// @return false if the queue was closed, in which case the item is dropped
+    bool push (T &&x)
+    {
+        std::unique_lock<std::mutex> lock (m);
+        not_full.wait (lock, [&] { return closed || q.size () < capacity; });
+        if (closed)
+            return false;
+        q.push_back (std::move (x));
+        not_empty.notify_one ();
+        return true;
+    }
+    /// @brief remove an item, waiting for one to arrive
+    ///
+    /// @return false if the queue is closed and there are no more items
+    bool pop (T &x)
+    {
+        std::unique_lock<std::mutex> lock (m);
+        not_empty.wait (lock, [&] { return closed || !q.empty (); });
+        if (q.empty ())
+            return false;
+        x = std::move (q.front ());
+        q.pop_front ();
+        not_full.notify_one ();
+        return true;
+    }
+    /// @brief stop accepting items, and wake everyone who is waiting
+    ///
+    /// Items that are already in the queue may still be removed.
+    void close ()
+    {
+        std::lock_guard<std::mutex> lock (m);
+        closed = true;
+        not_full.notify_all ();
+        not_empty.notify_all ();
+    }
+    private:
+    const size_t capacity;
+    bool closed;
+    std::deque<T> q;
+    std::mutex m;
+    std::condition_variable not_full;
+    std::condition_variable not_empty;
+};
+
+/// @brief run jobs through three concurrent stages
+///
+/// @param n the number of jobs
+/// @param first functor that starts job i and returns its state, typically by decoding an input
+/// @param second functor that updates the state, typically with the compute bound work
+/// @param third functor that finishes the state, typically by encoding an output
+/// @param depth the number of jobs that may wait between two stages
+///
+/// Each stage runs in its own thread, so while job i is in the second stage, job i + 1 may be in the first stage and
+/// job i - 1 may be in the third.  Jobs go through each stage in order.  At most 2 * depth + 3 jobs are in flight at
+/// once, which bounds memory use.
+///
+/// The stages should handle errors that only affect one job.  If a stage throws, the pipeline stops, and the first
+/// exception is rethrown once every stage has stopped.
+template<typename F1,typename F2,typename F3>
+void run_pipeline (const size_t n, F1 first, F2 second, F3 third, const size_t depth = 2)
+{
+    typedef decltype (first (0)) state_type;
+    bounded_queue<state_type> q1 (depth);
+    bounded_queue<state_type> q2 (depth);
+    std::mutex m;
+    std::exception_ptr error;
+    // stop every stage after the first failure
+    auto fail = [&] ()
+    {
+        {
+            std::lock_guard<std::mutex> lock (m);
+            if (!error)
+                error = std::current_exception ();
+        }
+        q1.close ();
+        q2.close ();
+    };
+    std::thread t1 ([&] ()
+    {
+        try
+        {
+            for (size_t i = 0; i < n; ++i)
+                if (!q1.push (first (i)))
+                    break;
+        }
+        catch (...)
+        {
+            fail ();
+        }
+        q1.close ();
+    });
+    std::thread t3 ([&] ()
+    {
+        try
+        {
+            state_type s;
+            while (q2.pop (s))
+                third (s);
+        }
+        catch (...)
+        {
+            fail ();
+        }
+    });
+    // the middle stage runs on the calling thread so that it may start its own parallel regions
+    try
+    {
+        state_type s;
+        while (q1.pop (s))
+        {
+            second (s);
+            if (!q2.push (std::move (s)))
+                break;
+        }
+    }
+    catch (...)
+    {
+        fail ();
+    }
+    q2.close ();
+    t1.join ();
+    t3.join ();
+    if (error)
+        std::rethrow_exception (error);
+}
+
+} // namespace image_tiler
+
+#endif // PIPELINE_H
@@ -0,0 +1,213 @@
+/// @file polygon_soup.h
+/// @brief many polygons in flat storage
+/// @author Jeff Perry <jeffsp@gmail.com>
+/// @version 1.0
+/// @date 2014-07-27
+
+#ifndef POLYGON_SOUP_H
+#define POLYGON_SOUP_H
+
+#include "geometry.h"
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <vector>
+
+namespace image_tiler
+{
+
+/// @brief many polygons, with all of their vertices in one array
+///
+/// A polygons container makes one allocation for each polygon, but a soup only has a handful of arrays: the vertices
+/// of every polygon, back to back, the offset of each polygon's first vertex, 32 bit tile and polygon indexes, and the
+/// bounding rectangle of each polygon, which is computed when the polygon is added.
+///
+/// Indexing a soup gives a lightweight view of one polygon, which has the same interface as a polygon, so templates
+/// that take polygons also take soups.  The vertices are stored as interleaved points, rather than as separate x and y
+/// arrays, because the rasterizer reads them as points, and the transform kernels read them as interleaved pairs.
+class polygon_soup
+{
+    public:
+    /// @brief a view of one polygon in a soup
+    class const_reference
+    {
+        public:
+        typedef const point *const_iterator;
+        typedef const point *iterator;
+        const_reference (const polygon_soup &s, const size_t i)
+            : s (&s), i (i)
+        { }
+        size_t size () const { return s->offsets[i + 1] - s->offsets[i]; }
+        bool empty () const { return size () == 0; }
+        const point &operator[] (const size_t j) const
+        {
+            assert (j < size ());
+            return s->vertices[s->offsets[i] + j];
+        }
+        const point *begin () const { return s->vertices.data () + s->offsets[i]; }
+        const point *end () const { return s->vertices.data () + s->offsets[i + 1]; }
+        const point &back () const { return *(end () - 1); }
+        size_t get_tile_index () const { return s->tile_ids[i]; }
+        size_t get_polygon_index () const { return s->polygon_ids[i]; }
+        /// @brief get the bounding rectangle of the polygon
+        const rectf &get_bounds () const { return s->bounds[i]; }
+        /// @brief copy the polygon
+        operator polygon () const
+        {
+            polygon p;
+            for (const auto &v : *this)
+                p.push_back (v);
+            p.set_tile_index (get_tile_index ());
+            p.set_polygon_index (get_polygon_index ());
+            return p;
+        }
+        private:
+        const polygon_soup *s;
+        size_t i;
+    };
+
+    /// @brief iterates over the views of the polygons
+    class const_iterator
+    {
+        public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef polygon_soup::const_reference value_type;
+        typedef ptrdiff_t difference_type;
+        typedef void pointer;
+        typedef polygon_soup::const_reference reference;
+        const_iterator (const polygon_soup &s, const size_t i)
+            : s (&s), i (i)
+        { }
+        const_reference operator* () const { return const_reference (*s, i); }
+        const_iterator &operator++ () { ++i; return *this; }
+        bool operator== (const const_iterator &j) const { return i == j.i; }
+        bool operator!= (const const_iterator &j) const { return i != j.i; }
+        private:
+        const polygon_soup *s;
+        size_t i;
+    };
+
+    polygon_soup ()
+        : offsets (1, 0)
+    { }
+    /// @brief copy polygons into a soup
+    polygon_soup (const polygons &p)
+        : offsets (1, 0)
+    {
+        size_t n = 0;
+        for (const auto &i : p)
+            n += i.size ();
+        reserve (p.size (), n);
+        for (const auto &i : p)
+            push_back (i);
+    }
+    size_t size () const { return tile_ids.size (); }
+    bool empty () const { return tile_ids.empty (); }
+    /// @brief get the total number of vertices
+    size_t vertex_count () const { return vertices.size (); }
+    void reserve (const size_t polys, const size_t verts)
+    {
+        vertices.reserve (verts);
+        offsets.reserve (polys + 1);
+        tile_ids.reserve (polys);
+        polygon_ids.reserve (polys);
+        bounds.reserve (polys);
+    }
+    void clear ()
+    {
+        vertices.clear ();
+        offsets.assign (1, 0);
+        tile_ids.clear ();
+        polygon_ids.clear ();
+        bounds.clear ();
+    }
+    const_reference operator[] (const size_t i) const
+    {
+        assert (i < size ());
+        return const_reference (*this, i);
+    }
+    const_iterator begin () const { return const_iterator (*this, 0); }
+    const_iterator end () const { return const_iterator (*this, size ()); }
+    /// @brief append a polygon, or a view of one
+    template<typename P>
+    void push_back (const P &p)
+    {
+        for (const auto &v : p)
+            vertices.push_back (v);
+        finish (vertices.size (), p.get_tile_index (), p.get_polygon_index ());
+    }
+    /// @brief append a polygon from a soup, along with its bounding rectangle
+    void push_back (const const_reference &p)
+    {
+        vertices.insert (vertices.end (), p.begin (), p.end ());
+        offsets.push_back (vertices.size ());
+        tile_ids.push_back (p.get_tile_index ());
+        polygon_ids.push_back (p.get_polygon_index ());
+        bounds.push_back (p.get_bounds ());
+    }
+    /// @brief append a transformed copy of every polygon in another soup
+    ///
+    /// @param s the polygons to append
+    /// @param m the transform
+    /// @param tile_index the tile index of the first appended polygon, which is incremented for each one
+    ///
+    /// Polygon i of s gets polygon index i, as in get_tiled_polygons ().  All of the vertices are transformed in one
+    /// batch.
+    void append (const polygon_soup &s, const affine2 &m, size_t tile_index)
+    {
+        const size_t v0 = vertices.size ();
+        vertices.resize (v0 + s.vertices.size ());
+        transform (m, s.vertices.data (), vertices.data () + v0, s.vertices.size ());
+        for (size_t i = 0; i < s.size (); ++i)
+            finish (v0 + s.offsets[i + 1], tile_index++, i);
+    }
+    /// @brief get every vertex of every polygon
+    const std::vector<point> &get_vertices () const { return vertices; }
+    /// @brief get the offset of the first vertex of each polygon, plus one past the last vertex
+    const std::vector<uint32_t> &get_offsets () const { return offsets; }
+    private:
+    /// @brief add a polygon whose vertices have already been stored, and which end at 'end'
+    void finish (const size_t end, const size_t tile_index, const size_t polygon_index)
+    {
+        assert (end <= std::numeric_limits<uint32_t>::max ());
+        assert (tile_index <= std::numeric_limits<uint32_t>::max ());
+        assert (polygon_index <= std::numeric_limits<uint32_t>::max ());
+        rectf r;
+        r.minx = r.miny = std::numeric_limits<double>::max ();
+        r.maxx = r.maxy = std::numeric_limits<double>::lowest ();
+        for (size_t j = offsets.back (); j < end; ++j)
+        {
+            const point &v = vertices[j];
+            r.minx = std::min (r.minx, v.x);
+            r.miny = std::min (r.miny, v.y);
+            r.maxx = std::max (r.maxx, v.x);
+            r.maxy = std::max (r.maxy, v.y);
+        }
+        offsets.push_back (end);
+        tile_ids.push_back (tile_index);
+        polygon_ids.push_back (polygon_index);
+        bounds.push_back (r);
+    }
+    std::vector<point> vertices;
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> tile_ids;
+    std::vector<uint32_t> polygon_ids;
+    std::vector<rectf> bounds;
+};
+
+/// @brief copy the polygons of a soup
+polygons to_polygons (const polygon_soup &s)
+{
+    polygons p;
+    p.reserve (s.size ());
+    for (const auto &i : s)
+        p.push_back (i);
+    return p;
+}
+
+} // namespace image_tiler
+
+#endif // POLYGON_SOUP_H
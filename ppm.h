@@ -0,0 +1,182 @@
+/// @file ppm.h
+/// @brief netpbm PPM/PAM support
+/// @author Jeff Perry <jeffsp@gmail.com>
+/// @version 1.0
+/// @date 2014-07-27
+
+#ifndef PPM_H
+#define PPM_H
+
+#include "image.h"
+#include "utils.h"
+#include <cassert>
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace image_tiler
+{
+
+/// @brief the parts of a PPM or PAM header that we care about
+struct ppm_header
+{
+    ppm_header ()
+        : rows (0), cols (0), channels (0), maxval (0), offset (0)
+    { }
+    size_t rows;
+    size_t cols;
+    size_t channels;
+    size_t maxval;
+    /// @brief offset of the first pixel from the start of the file
+    size_t offset;
+};
+
+/// @brief check if a filename has a PPM or PAM extension
+bool is_ppm_filename (const std::string &fn)
+{
+    const std::string ext = get_extension (fn);
+    return ext == "ppm" || ext == "pam";
+}
+
+/// @brief get the next whitespace delimited PPM header token, skipping comments
+std::string get_ppm_token (std::istream &s)
+{
+    std::string t;
+    for (;;)
+    {
+        const int c = s.get ();
+        if (c == EOF)
+            break;
+        if (c == '#')
+        {
+            // comments run to the end of the line
+            std::string comment;
+            std::getline (s, comment);
+            if (!t.empty ())
+                break;
+            continue;
+        }
+        if (isspace (c))
+        {
+            if (!t.empty ())
+                break;
+            continue;
+        }
+        t.push_back (c);
+    }
+    return t;
+}
+
+/// @brief read a binary PPM (P6) or PAM (P7) header
+///
+/// @param s the stream, which will be positioned at the first pixel
+///
+/// @return the header
+///
+/// Only 8 bit RGB data is supported.
+ppm_header read_ppm_header (std::istream &s)
+{
+    ppm_header h;
+    const std::string magic = get_ppm_token (s);
+    if (magic == "P6")
+    {
+        h.cols = std::stoul (get_ppm_token (s));
+        h.rows = std::stoul (get_ppm_token (s));
+        // the single whitespace after maxval is consumed by get_ppm_token ()
+        h.maxval = std::stoul (get_ppm_token (s));
+        h.channels = 3;
+    }
+    else if (magic == "P7")
+    {
+        std::string line;
+        while (std::getline (s, line))
+        {
+            if (line.empty () || line[0] == '#')
+                continue;
+            std::stringstream ss (line);
+            std::string key;
+            ss >> key;
+            if (key == "ENDHDR")
+                break;
+            else if (key == "WIDTH")
+                ss >> h.cols;
+            else if (key == "HEIGHT")
+                ss >> h.rows;
+            else if (key == "DEPTH")
+                ss >> h.channels;
+            else if (key == "MAXVAL")
+                ss >> h.maxval;
+        }
+    }
+    else
+        throw std::runtime_error ("not a binary PPM or PAM file");
+    if (!s)
+        throw std::runtime_error ("could not read PPM header");
+    if (h.maxval != 255 || h.channels != 3)
+        throw std::runtime_error ("only 8 bit RGB PPM and PAM files are supported");
+    h.offset = s.tellg ();
+    return h;
+}
+
+/// @brief write a binary PPM header
+void write_ppm_header (std::ostream &s, const size_t rows, const size_t cols)
+{
+    s << "P6\n" << cols << ' ' << rows << "\n255\n";
+}
+
+/// @brief read a PPM or PAM file a few rows at a time
+class ppm_band_reader
+{
+    public:
+    explicit ppm_band_reader (const std::string &fn)
+        : ifs (fn.c_str (), std::ios::binary)
+    {
+        if (!ifs)
+            throw std::runtime_error ("could not open file for reading");
+        h = read_ppm_header (ifs);
+    }
+    size_t rows () const { return h.rows; }
+    size_t cols () const { return h.cols; }
+    /// @brief read the next n rows into the top of a band
+    void read (rgb8_image_t &band, const size_t n)
+    {
+        assert (band.cols () == h.cols);
+        assert (n <= band.rows ());
+        ifs.read (reinterpret_cast<char *> (&band[0]), n * h.cols * 3);
+        if (!ifs)
+            throw std::runtime_error ("could not read PPM data");
+    }
+    private:
+    std::ifstream ifs;
+    ppm_header h;
+};
+
+/// @brief write a PPM file a few rows at a time
+class ppm_band_writer
+{
+    public:
+    ppm_band_writer (const std::string &fn, const size_t rows, const size_t cols)
+        : ofs (fn.c_str (), std::ios::binary)
+    {
+        if (!ofs)
+            throw std::runtime_error ("could not open file for writing");
+        write_ppm_header (ofs, rows, cols);
+    }
+    /// @brief write the top n rows of a band
+    void write (const rgb8_image_t &band, const size_t n)
+    {
+        assert (n <= band.rows ());
+        ofs.write (reinterpret_cast<const char *> (&band[0]), n * band.cols () * 3);
+        if (!ofs)
+            throw std::runtime_error ("could not write PPM data");
+    }
+    private:
+    std::ofstream ofs;
+};
+
+} // namespace image_tiler
+
+#endif // PPM_H
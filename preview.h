@@ -0,0 +1,250 @@
+/// @file preview.h
+/// @brief incrementally updated previews of a tiled image
+/// @author Jeff Perry <jeffsp@gmail.com>
+/// @version 1.0
+/// @date 2014-07-27
+
+#ifndef PREVIEW_H
+#define PREVIEW_H
+
+#include "geometry.h"
+#include "graphics.h"
+#include "image_elements.h"
+#include "pyramid.h"
+#include "raster_cache.h"
+#include "tiler.h"
+#include "tiles.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace image_tiler
+{
+
+/// @brief the parameters of a preview
+struct preview_params
+{
+    preview_params ()
+        : tile_index (10), scale (30.0), angle (0.0), xoffset (0.0), yoffset (0.0), randomize (false), transparency (0),
+        outline (false), min_pixels (0)
+    { }
+    unsigned tile_index;
+    double scale;
+    double angle;
+    double xoffset;
+    double yoffset;
+    bool randomize;
+    /// @brief percentage of the original image that shows through
+    unsigned transparency;
+    bool outline;
+    /// @brief if not 0, means are taken from a pyramid, see get_region_stats ()
+    size_t min_pixels;
+};
+
+/// @brief a tiled image that is built by a chain of cached stages
+///
+/// The stages are, in order, geometry, scanlines, means, colors, mosaic and composite.  Each stage only depends on
+/// the stages before it, and changing a parameter invalidates the first stage that uses it, along with every stage
+/// after that one.  For example, changing the transparency only recomposites the mosaic with the original, and
+/// changing the angle starts over.
+template<typename I>
+class preview
+{
+    public:
+    /// @brief constructor
+    ///
+    /// @param original the image to tile, which must outlive the preview
+    /// @param tl the tiles
+    preview (const I &original, const tile_list &tl)
+        : original (original), tl (tl), valid (0)
+    { }
+    const preview_params &get_params () const { return params; }
+    const I &get_original () const { return original; }
+    /// @brief set new parameters, invalidating the stages that depend on them
+    void set_params (const preview_params &p)
+    {
+        if (p.tile_index != params.tile_index
+            || p.scale != params.scale
+            || p.angle != params.angle
+            || p.xoffset != params.xoffset
+            || p.yoffset != params.yoffset)
+            invalidate (geometry);
+        if (p.min_pixels != params.min_pixels)
+            invalidate (means);
+        if (p.randomize != params.randomize)
+            invalidate (colors);
+        if (p.transparency != params.transparency || p.outline != params.outline)
+            invalidate (composite);
+        params = p;
+    }
+    /// @brief indicates if bringing the image up to date needs work that grows with the number of polygons
+    ///
+    /// That is placing, rasterizing or averaging the polygons, or drawing their outlines for the first time.  Anything
+    /// else only recolors or recomposites the image.
+    bool needs_geometry_work () const
+    {
+        return valid <= means || (params.outline && outlines.empty ());
+    }
+    /// @brief get the polygons that cover the window, and the elements of the tiled image
+    const image_elements &get_elements ()
+    {
+        update (colors);
+        return e;
+    }
+    /// @brief get every polygon that was placed, including those near the window that do not intersect it
+    const polygon_soup &get_all_polygons ()
+    {
+        update (geometry);
+        return all_polys;
+    }
+    /// @brief get the image to show
+    const I &get_image ()
+    {
+        update (composite);
+        return comp;
+    }
+    /// @brief bring every stage up to date, unless the work is cancelled
+    ///
+    /// @param cancelled functor that is checked before each stage starts
+    ///
+    /// @return true if the image is ready, false if the work was cancelled
+    ///
+    /// Stages that finish before the work is cancelled stay valid, so they do not have to be recomputed unless the
+    /// parameters that they depend on change.
+    template<typename F>
+    bool render (F cancelled)
+    {
+        return update (composite, cancelled);
+    }
+    /// @brief bring every stage but the last up to date, and composite the image to show into img
+    ///
+    /// @param cancelled functor that is checked before each stage starts
+    /// @param img the image to show, which is resized to fit
+    ///
+    /// @return true if the image is ready, false if the work was cancelled
+    ///
+    /// The image is written in one pass, so it does not have to be copied out of the preview.
+    template<typename F>
+    bool render (F cancelled, I &img)
+    {
+        if (!update (mosaic, cancelled))
+            return false;
+        compose (img);
+        return true;
+    }
+    private:
+    enum stage { geometry, scanlines, means, colors, mosaic, composite, stages };
+    /// @brief blend the mosaic with the original and overlay the outlines
+    void compose (I &img)
+    {
+        if (params.outline && outlines.empty ())
+        {
+            // outlines only depend on the geometry, so they are drawn once and overlaid on every composite
+            outlines = grayscale8_image_t (original.rows (), original.cols ());
+            for (const auto &i : all_polys)
+                draw_lines (outlines, i, 255);
+        }
+        const rgb8_pixel_t c {212, 212, 212};
+        if (params.outline)
+            composite_image (original, mos, params.transparency, outlines, c, img);
+        else
+            composite_image (original, mos, params.transparency, grayscale8_image_t (), c, img);
+    }
+    void invalidate (const stage s)
+    {
+        valid = std::min (valid, static_cast<unsigned> (s));
+    }
+    /// @brief run every invalid stage up to and including s
+    void update (const stage s)
+    {
+        update (s, [] () { return false; });
+    }
+    template<typename F>
+    bool update (const stage s, F cancelled)
+    {
+        for (; valid <= static_cast<unsigned> (s); ++valid)
+        {
+            if (cancelled ())
+                return false;
+            switch (static_cast<stage> (valid))
+            {
+                default: assert (0); break;
+                case geometry:
+                {
+                    const size_t w = original.cols ();
+                    const size_t h = original.rows ();
+                    const convex_uniform_tile &t = tl[params.tile_index];
+                    const double tw = params.scale * t.get_width ();
+                    const double th = params.scale * t.get_height ();
+                    const auto locs = get_window_tile_locations (h, w, point (params.xoffset + w / 2.0, params.yoffset + h / 2.0), tw, th, params.angle, t.is_triangular (), get_tile_extent (t.get_polygons (), params.scale, params.angle));
+                    all_polys = get_tiled_polygon_soup (locs, t.get_polygons (), params.scale, params.angle);
+                    e.p = get_intersecting_polygons (w, h, all_polys);
+                    prototypes = get_prototype_polygons (t.get_polygons (), params.scale, params.angle);
+                    outlines = grayscale8_image_t ();
+                }
+                break;
+                case scanlines:
+                // repeated shapes are only rasterized once
+                e.s = clip_scanlines (original.cols (), original.rows (), get_polygon_scanlines (e.p, prototypes, raster_cache_mode::exact));
+                break;
+                case means:
+                if (params.min_pixels == 0)
+                    m = get_colors (get_region_stats (original, e.s));
+                else
+                {
+                    // the pyramid is built the first time it is needed, and kept for every later render
+                    if (!pyr)
+                        pyr.reset (new image_pyramid<I> (original));
+                    m = get_colors (get_region_stats (*pyr, e.s, params.min_pixels));
+                }
+                break;
+                case colors:
+                {
+                    e.m = m;
+                    if (params.randomize)
+                    {
+                        // shuffle the colors
+                        for (auto &i : e.m)
+                            std::swap (i, e.m[rand () % e.m.size ()]);
+                    }
+                }
+                break;
+                case mosaic:
+                {
+                    mos = original;
+                    fill (mos, e.s, e.m);
+                }
+                break;
+                case composite:
+                compose (comp);
+                break;
+            }
+        }
+        return true;
+    }
+    const I &original;
+    const tile_list &tl;
+    preview_params params;
+    /// @brief the number of leading stages that are up to date
+    unsigned valid;
+    polygon_soup all_polys;
+    polygons prototypes;
+    std::unique_ptr<image_pyramid<I>> pyr;
+    image_elements e;
+    /// @brief mean color of each element
+    std::vector<rgb8_pixel_t> m;
+    /// @brief the original, with the elements filled in
+    I mos;
+    /// @brief pixels of the outlines of every polygon, drawn when they are first shown
+    grayscale8_image_t outlines;
+    /// @brief the mosaic, blended with the original and outlined
+    I comp;
+};
+
+} // namespace image_tiler
+
+#endif // PREVIEW_H
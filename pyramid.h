@@ -0,0 +1,149 @@
+/// @file pyramid.h
+/// @brief region statistics from a pyramid of downsampled images
+/// @author Jeff Perry <jeffsp@gmail.com>
+/// @version 1.0
+/// @date 2014-07-27
+
+#ifndef PYRAMID_H
+#define PYRAMID_H
+
+#include "graphics.h"
+#include "image.h"
+#include "stats.h"
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace image_tiler
+{
+
+/// @brief an image and copies of it that are repeatedly shrunk by a factor of 2
+///
+/// Level 0 is the image itself, and each pixel of level L is the mean of a 2^L x 2^L block of the image.  The levels
+/// above 0 take about a third of the memory of the image.  A pyramid only has to be built once for each image, and it
+/// can be used for any number of tilings.
+template<typename I>
+class image_pyramid
+{
+    public:
+    /// @brief constructor
+    ///
+    /// @param original the image, which must outlive the pyramid
+    /// @param max_levels the maximum number of levels, including level 0
+    explicit image_pyramid (const I &original, const size_t max_levels = 7)
+        : original (original)
+    {
+        assert (max_levels != 0);
+        const I *p = &original;
+        while (levels.size () + 1 < max_levels && (p->rows () > 1 || p->cols () > 1))
+        {
+            levels.push_back (shrink (*p, 2));
+            p = &levels.back ();
+        }
+    }
+    /// @brief get the number of levels, including level 0
+    size_t size () const { return levels.size () + 1; }
+    /// @brief get a level
+    const I &operator[] (const size_t l) const
+    {
+        assert (l < size ());
+        return l == 0 ? original : levels[l - 1];
+    }
+    /// @brief get the coarsest level on which a region still covers a given number of pixels
+    ///
+    /// @param pixels number of pixels in the region on level 0
+    /// @param min_pixels the number of pixels to keep
+    size_t get_level (const size_t pixels, const size_t min_pixels) const
+    {
+        size_t l = 0;
+        while (l + 1 < size () && (pixels >> (2 * (l + 1))) >= min_pixels)
+            ++l;
+        return l;
+    }
+    private:
+    const I &original;
+    std::vector<I> levels;
+};
+
+/// @brief get the mean of a region from the coarsest pyramid level that keeps enough of its pixels
+///
+/// @param pyr the pyramid
+/// @param s scanlines that cover the region on level 0
+/// @param min_pixels the region must cover at least this many pixels on the level that is used
+///
+/// @return the region statistics, with the count and mean filled in; the count is the number of level 0 pixels
+///
+/// A pixel of level L is used if the center of its block is covered by the scanlines.  The mean of a block that lies
+/// entirely inside the region is exact, but a block that straddles the region's edge also averages pixels from outside
+/// of it.  If N pixels of level L are used, and B of them straddle the edge, the error of each channel is at most
+///
+///     255 B / N + L / 2 + 1 / 2
+///
+/// where the last two terms come from rounding each level and rounding the mean.  B is about the length of the edge,
+/// in pixels of level L, so for convex regions the first term shrinks like 1 / sqrt (N), and on smooth images it is
+/// much smaller than the bound.  Regions that cover fewer than 4 min_pixels pixels use level 0, and get the same
+/// result as get_region_stats (img, s).
+template<typename T,size_t CHANNELS,typename Cont,typename Order>
+region_stats<CHANNELS> get_region_stats (const image_pyramid<image<T,CHANNELS,Cont,Order>> &pyr, const scanlines &s, const size_t min_pixels)
+{
+    assert (min_pixels != 0);
+    size_t pixels = 0;
+    for (const auto &i : s)
+        pixels += i.len;
+    const size_t l = pyr.get_level (pixels, min_pixels);
+    if (l == 0)
+        return get_region_stats (pyr[0], s);
+    const auto &img = pyr[l];
+    const size_t rows = pyr[0].rows ();
+    const size_t cols = pyr[0].cols ();
+    const size_t f = size_t (1) << l;
+    // the center of block b, which may be cut off by the edge of the image
+    auto center = [f] (const size_t b, const size_t n) { return b * f + std::min (f, n - b * f) / 2; };
+    std::array<uint64_t,CHANNELS> sum;
+    sum.fill (0);
+    size_t count = 0;
+    for (const auto &i : s)
+    {
+        const size_t y = i.y;
+        // only the scanlines through the centers of blocks are used
+        if (y != center (y / f, rows))
+            continue;
+        const size_t x1 = i.x;
+        const size_t x2 = i.x + i.len;
+        for (size_t b = x1 / f; b * f < x2; ++b)
+        {
+            const size_t x = center (b, cols);
+            if (x < x1 || x >= x2)
+                continue;
+            const T *p = &img[img.index (y / f, b, 0) - Order::channel (0)];
+            for (size_t k = 0; k < CHANNELS; ++k)
+                sum[k] += p[k];
+            ++count;
+        }
+    }
+    // thin regions may miss every center
+    if (count == 0)
+        return get_region_stats (pyr[0], s);
+    region_stats<CHANNELS> r;
+    r.count = pixels;
+    for (size_t k = 0; k < CHANNELS; ++k)
+        r.mean[k] = ::round (static_cast<double> (sum[Order::channel (k)]) / count);
+    return r;
+}
+
+/// @brief get the means of many regions from a pyramid
+template<typename T,size_t CHANNELS,typename Cont,typename Order>
+std::vector<region_stats<CHANNELS>> get_region_stats (const image_pyramid<image<T,CHANNELS,Cont,Order>> &pyr, const std::vector<scanlines> &ps, const size_t min_pixels)
+{
+    std::vector<region_stats<CHANNELS>> r (ps.size ());
+#pragma omp parallel for schedule (dynamic, 256)
+    for (size_t i = 0; i < ps.size (); ++i)
+        r[i] = get_region_stats (pyr, ps[i], min_pixels);
+    return r;
+}
+
+} // namespace image_tiler
+
+#endif // PYRAMID_H
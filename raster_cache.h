@@ -0,0 +1,177 @@
+/// @file raster_cache.h
+/// @brief rasterize repeated polygons once, and reuse their scanlines
+/// @author Jeff Perry <jeffsp@gmail.com>
+/// @version 1.0
+/// @date 2014-07-27
+
+#ifndef RASTER_CACHE_H
+#define RASTER_CACHE_H
+
+#include "geometry.h"
+#include "graphics.h"
+#include "tiler.h"
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace image_tiler
+{
+
+/// @brief how repeated polygons are matched to cached scanlines
+enum class raster_cache_mode
+{
+    /// @brief rasterize every polygon
+    none,
+    /// @brief reuse scanlines when the rounded vertices are the same, up to an integer translation
+    exact,
+    /// @brief reuse scanlines when the prototype and its sub-pixel offset, rounded to a fraction of a pixel, are the same
+    quantized
+};
+
+/// @brief get the prototype polygons that tiled polygons are translated copies of
+///
+/// @param polys polygons contained in one tile
+/// @param scale scale of the tile
+/// @param angle angle of the tile
+///
+/// Polygon i of the result is the one that get_tiled_polygons () translates to get polygons with polygon index i.
+polygons get_prototype_polygons (const polygons &polys, const double scale, const double angle)
+{
+    return get_tiled_polygons (points (1, point (0, 0)), polys, scale, angle);
+}
+
+/// @brief a vector of integers that can be used as a hash key
+struct int_vector_hash
+{
+    size_t operator() (const std::vector<int> &v) const
+    {
+        uint64_t h = 1469598103934665603ull;
+        for (auto i : v)
+        {
+            h ^= static_cast<uint32_t> (i);
+            h *= 1099511628211ull;
+        }
+        return h;
+    }
+};
+
+/// @brief get the scanlines of many polygons, rasterizing each distinct shape only once
+///
+/// @param p the polygons, or a polygon soup, which must come from get_tiled_polygons () or get_tiled_polygon_soup ()
+/// @param prototypes the prototypes of the polygons, from get_prototype_polygons ()
+/// @param mode how polygons are matched
+/// @param subpixels number of sub-pixel offsets per pixel in quantized mode
+///
+/// @return container of container of scanlines
+///
+/// In exact mode, the key of a polygon is the list of its rounded vertices, relative to its first rounded vertex.  The
+/// rasterizer only uses the rounded vertices, and it only does integer arithmetic with them, so polygons with equal
+/// keys have the same scanlines, up to an integer translation.  The result is identical to get_polygon_scanlines ().
+///
+/// In quantized mode, the key of a polygon is its prototype and the fractional part of its translation, rounded to
+/// 1 / subpixels pixels, so no vertices need to be rounded.  The result may differ from get_polygon_scanlines () by
+/// one pixel along some edges.
+template<typename PS>
+polygon_scanlines get_polygon_scanlines (const PS &p, const polygons &prototypes, const raster_cache_mode mode, const unsigned subpixels = 16)
+{
+    if (mode == raster_cache_mode::none)
+        return get_polygon_scanlines (p);
+    assert (subpixels != 0);
+    const size_t n = p.size ();
+    // the key and integer translation of each polygon
+    std::vector<uint32_t> keys (n);
+    std::vector<int> dx (n);
+    std::vector<int> dy (n);
+    // a polygon that has each key, translated so that it is near the origin
+    polygons shapes;
+    if (mode == raster_cache_mode::exact)
+    {
+        std::unordered_map<std::vector<int>,uint32_t,int_vector_hash> ids;
+        std::vector<int> key;
+        for (size_t i = 0; i < n; ++i)
+        {
+            key.clear ();
+            if (!p[i].empty ())
+            {
+                const point a = round (p[i][0]);
+                dx[i] = static_cast<int> (a.x);
+                dy[i] = static_cast<int> (a.y);
+                for (const auto &j : p[i])
+                {
+                    const point b = round (j);
+                    key.push_back (static_cast<int> (b.x - a.x));
+                    key.push_back (static_cast<int> (b.y - a.y));
+                }
+            }
+            const auto k = ids.insert (std::make_pair (key, static_cast<uint32_t> (shapes.size ())));
+            if (k.second)
+            {
+                polygon s;
+                for (size_t j = 0; j < key.size (); j += 2)
+                    s.push_back (point (key[j], key[j + 1]));
+                shapes.push_back (s);
+            }
+            keys[i] = k.first->second;
+        }
+    }
+    else
+    {
+        // every prototype and sub-pixel offset has a slot
+        std::vector<uint32_t> ids (prototypes.size () * subpixels * subpixels, UINT32_MAX);
+        for (size_t i = 0; i < n; ++i)
+        {
+            const size_t k = p[i].get_polygon_index ();
+            assert (k < prototypes.size ());
+            assert (p[i].size () == prototypes[k].size ());
+            // recover the translation
+            const point o (p[i][0].x - prototypes[k][0].x, p[i][0].y - prototypes[k][0].y);
+            const double fx = ::floor (o.x);
+            const double fy = ::floor (o.y);
+            int qx = ::round ((o.x - fx) * subpixels);
+            int qy = ::round ((o.y - fy) * subpixels);
+            dx[i] = static_cast<int> (fx);
+            dy[i] = static_cast<int> (fy);
+            if (qx == static_cast<int> (subpixels))
+            {
+                qx = 0;
+                ++dx[i];
+            }
+            if (qy == static_cast<int> (subpixels))
+            {
+                qy = 0;
+                ++dy[i];
+            }
+            uint32_t &id = ids[(k * subpixels + qx) * subpixels + qy];
+            if (id == UINT32_MAX)
+            {
+                id = shapes.size ();
+                const point f (static_cast<double> (qx) / subpixels, static_cast<double> (qy) / subpixels);
+                polygon s;
+                for (const auto &j : prototypes[k])
+                    s.push_back (j + f);
+                shapes.push_back (s);
+            }
+            keys[i] = id;
+        }
+    }
+    // rasterize each shape once
+    const polygon_scanlines cached = get_polygon_scanlines (shapes);
+    // stamp the cached scanlines at each polygon's translation
+    polygon_scanlines ps (n);
+#pragma omp parallel for schedule (dynamic, 256)
+    for (size_t i = 0; i < n; ++i)
+    {
+        const scanlines &c = cached[keys[i]];
+        scanlines &s = ps[i];
+        s.resize (c.size ());
+        for (size_t j = 0; j < c.size (); ++j)
+            s[j] = scanline (c[j].y + dy[i], c[j].x + dx[i], c[j].len);
+    }
+    return ps;
+}
+
+} // namespace image_tiler
+
+#endif // RASTER_CACHE_H
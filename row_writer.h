@@ -0,0 +1,256 @@
+/// @file row_writer.h
+/// @brief encode PNG and JPEG files a row at a time
+/// @author Jeff Perry <jeffsp@gmail.com>
+/// @version 1.0
+/// @date 2014-07-27
+
+#ifndef ROW_WRITER_H
+#define ROW_WRITER_H
+
+#include "image.h"
+#include "ppm.h"
+#include "utils.h"
+#include <cassert>
+#include <csetjmp>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <jpeglib.h>
+#include <png.h>
+
+namespace image_tiler
+{
+
+/// @brief write a PNG file a row at a time
+///
+/// The rows are interlaced 8 bit RGB.  The file is finished when its last row is written.
+class png_row_writer
+{
+    public:
+    png_row_writer (const std::string &fn, const size_t rows, const size_t cols, const int compression = 1)
+        : fp (fopen (fn.c_str (), "wb"))
+        , png (nullptr)
+        , info (nullptr)
+        , rows (rows)
+        , row (0)
+    {
+        if (!fp)
+            throw std::runtime_error ("could not open file for writing");
+        png = png_create_write_struct (PNG_LIBPNG_VER_STRING, this, on_error, on_warning);
+        if (png)
+            info = png_create_info_struct (png);
+        if (!png || !info)
+        {
+            destroy ();
+            throw std::runtime_error ("could not create PNG encoder");
+        }
+        if (setjmp (png_jmpbuf (png)))
+        {
+            destroy ();
+            throw std::runtime_error (error);
+        }
+        png_init_io (png, fp);
+        png_set_IHDR (png, info, cols, rows, 8, PNG_COLOR_TYPE_RGB, PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+        png_set_compression_level (png, compression);
+        png_write_info (png, info);
+    }
+    ~png_row_writer ()
+    {
+        destroy ();
+    }
+    png_row_writer (const png_row_writer &) = delete;
+    png_row_writer &operator= (const png_row_writer &) = delete;
+    /// @brief write the next row
+    void write_row (const unsigned char *p)
+    {
+        assert (row < rows);
+        if (setjmp (png_jmpbuf (png)))
+            throw std::runtime_error (error);
+        png_write_row (png, const_cast<unsigned char *> (p));
+        if (++row == rows)
+        {
+            png_write_end (png, info);
+            if (fflush (fp) != 0)
+                throw std::runtime_error ("could not write PNG data");
+        }
+    }
+    /// @brief write the top n rows of a band
+    void write (const rgb8_image_t &band, const size_t n)
+    {
+        assert (n <= band.rows ());
+        for (size_t i = 0; i < n; ++i)
+            write_row (&band (i, 0, 0));
+    }
+    private:
+    static void on_error (png_structp png, png_const_charp msg)
+    {
+        png_row_writer *w = static_cast<png_row_writer *> (png_get_error_ptr (png));
+        w->error = std::string ("PNG error: ") + msg;
+        longjmp (png_jmpbuf (png), 1);
+    }
+    static void on_warning (png_structp, png_const_charp)
+    {
+    }
+    void destroy ()
+    {
+        if (png)
+            png_destroy_write_struct (&png, info ? &info : nullptr);
+        png = nullptr;
+        info = nullptr;
+        if (fp)
+            fclose (fp);
+        fp = nullptr;
+    }
+    FILE *fp;
+    png_structp png;
+    png_infop info;
+    const size_t rows;
+    size_t row;
+    std::string error;
+};
+
+/// @brief write a JPEG file a row at a time
+///
+/// The rows are interlaced 8 bit RGB.  The file is finished when its last row is written.
+class jpeg_row_writer
+{
+    public:
+    jpeg_row_writer (const std::string &fn, const size_t rows, const size_t cols, const int quality = 95)
+        : fp (fopen (fn.c_str (), "wb"))
+        , rows (rows)
+        , row (0)
+        , created (false)
+    {
+        if (!fp)
+            throw std::runtime_error ("could not open file for writing");
+        c.err = jpeg_std_error (&err.mgr);
+        err.mgr.error_exit = on_error;
+        if (setjmp (err.jb))
+        {
+            destroy ();
+            throw std::runtime_error (err.msg);
+        }
+        jpeg_create_compress (&c);
+        created = true;
+        jpeg_stdio_dest (&c, fp);
+        c.image_width = cols;
+        c.image_height = rows;
+        c.input_components = 3;
+        c.in_color_space = JCS_RGB;
+        jpeg_set_defaults (&c);
+        jpeg_set_quality (&c, quality, TRUE);
+        jpeg_start_compress (&c, TRUE);
+    }
+    ~jpeg_row_writer ()
+    {
+        destroy ();
+    }
+    jpeg_row_writer (const jpeg_row_writer &) = delete;
+    jpeg_row_writer &operator= (const jpeg_row_writer &) = delete;
+    /// @brief write the next row
+    void write_row (const unsigned char *p)
+    {
+        assert (row < rows);
+        if (setjmp (err.jb))
+            throw std::runtime_error (err.msg);
+        JSAMPROW r = const_cast<unsigned char *> (p);
+        jpeg_write_scanlines (&c, &r, 1);
+        if (++row == rows)
+        {
+            jpeg_finish_compress (&c);
+            if (fflush (fp) != 0)
+                throw std::runtime_error ("could not write JPEG data");
+        }
+    }
+    /// @brief write the top n rows of a band
+    void write (const rgb8_image_t &band, const size_t n)
+    {
+        assert (n <= band.rows ());
+        for (size_t i = 0; i < n; ++i)
+            write_row (&band (i, 0, 0));
+    }
+    private:
+    struct error_manager
+    {
+        jpeg_error_mgr mgr;
+        jmp_buf jb;
+        char msg[JMSG_LENGTH_MAX];
+    };
+    static void on_error (j_common_ptr c)
+    {
+        // mgr is the first member
+        error_manager *e = reinterpret_cast<error_manager *> (c->err);
+        (*c->err->format_message) (c, e->msg);
+        longjmp (e->jb, 1);
+    }
+    void destroy ()
+    {
+        if (created)
+            jpeg_destroy_compress (&c);
+        created = false;
+        if (fp)
+            fclose (fp);
+        fp = nullptr;
+    }
+    FILE *fp;
+    jpeg_compress_struct c;
+    error_manager err;
+    const size_t rows;
+    size_t row;
+    bool created;
+};
+
+/// @brief indicates if a file can be written a row at a time by write_rows ()
+bool is_row_writer_filename (const std::string &fn)
+{
+    const std::string ext = get_extension (fn);
+    return ext == "ppm" || ext == "png" || ext == "jpg" || ext == "jpeg";
+}
+
+/// @brief write a PPM, PNG or JPEG file a row at a time
+///
+/// @param fn file name, the extension of which selects the encoder
+/// @param rows rows in the image
+/// @param cols cols in the image
+/// @param paint functor that fills the next row with interlaced 8 bit RGB pixels
+///
+/// Only one row of pixels is ever allocated.
+template<typename F>
+void write_rows (const std::string &fn, const size_t rows, const size_t cols, F paint)
+{
+    assert (is_row_writer_filename (fn));
+    rgb8_image_t band (1, cols);
+    const std::string ext = get_extension (fn);
+    if (ext == "ppm")
+    {
+        ppm_band_writer w (fn, rows, cols);
+        for (size_t i = 0; i < rows; ++i)
+        {
+            paint (&band[0]);
+            w.write (band, 1);
+        }
+    }
+    else if (ext == "png")
+    {
+        png_row_writer w (fn, rows, cols);
+        for (size_t i = 0; i < rows; ++i)
+        {
+            paint (&band[0]);
+            w.write_row (&band[0]);
+        }
+    }
+    else
+    {
+        jpeg_row_writer w (fn, rows, cols);
+        for (size_t i = 0; i < rows; ++i)
+        {
+            paint (&band[0]);
+            w.write_row (&band[0]);
+        }
+    }
+}
+
+} // namespace image_tiler
+
+#endif // ROW_WRITER_H
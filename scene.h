@@ -0,0 +1,455 @@
+/// @file scene.h
+/// @brief compact binary files that store a tiled image as instances of a tile's polygons
+/// @author Jeff Perry <jeffsp@gmail.com>
+/// @version 1.0
+/// @date 2014-07-27
+
+#ifndef SCENE_H
+#define SCENE_H
+
+#include "geometry.h"
+#include "graphics.h"
+#include "image.h"
+#include "mmap_image.h"
+#include "tiler.h"
+#include "tiles.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace image_tiler
+{
+
+/// @brief the fixed size part of a scene file
+///
+/// A scene file is laid out so that it can be mapped and used in place:
+///
+///     scene_header
+///     uint32_t offsets[polygons + 1], the first vertex of each of the tile's polygons, padded to 8 bytes
+///     double vertices[vertices][2], the tile's polygons, before they are scaled and rotated
+///     scene_instance instances[instances]
+///
+/// All values are in the byte order of the machine that wrote the file.
+struct scene_header
+{
+    char magic[8];
+    uint32_t version;
+    /// @brief the convex_uniform_tiling of the tile, for reference
+    uint32_t tiling;
+    /// @brief size of the tiled image
+    uint32_t rows;
+    uint32_t cols;
+    double scale;
+    double angle;
+    /// @brief the point that lattice coordinates (0, 0) are placed at
+    double origin_x;
+    double origin_y;
+    /// @brief size of the tile, before it is scaled
+    double tile_width;
+    double tile_height;
+    uint32_t is_triangular;
+    uint32_t polygons;
+    uint32_t vertices;
+    uint32_t reserved;
+    uint64_t instances;
+};
+
+static_assert (sizeof (scene_header) == 96, "the scene header must not be padded");
+
+/// @brief one polygon of a tiled image
+///
+/// The polygon is polygon 'polygon_index' of the tile that is at lattice column k of lattice row v, so it only takes
+/// 12 bytes, no matter how many vertices it has.
+struct scene_instance
+{
+    int32_t k;
+    int32_t v;
+    uint8_t polygon_index;
+    uint8_t color[3];
+};
+
+static_assert (sizeof (scene_instance) == 12, "scene instances must be packed");
+
+const char scene_magic[8] = { 'I', 'T', 'S', 'C', 'E', 'N', 'E', '\n' };
+const uint32_t scene_version = 1;
+
+/// @brief the byte offsets of the sections of a scene file
+struct scene_layout
+{
+    size_t offsets;
+    size_t vertices;
+    size_t instances;
+    size_t size;
+};
+
+scene_layout get_scene_layout (const scene_header &h)
+{
+    scene_layout l;
+    l.offsets = sizeof (scene_header);
+    l.vertices = (l.offsets + (h.polygons + 1) * sizeof (uint32_t) + 7) / 8 * 8;
+    l.instances = l.vertices + h.vertices * sizeof (point);
+    l.size = l.instances + h.instances * sizeof (scene_instance);
+    return l;
+}
+
+/// @brief collects the instances of a tiled image and writes them to a scene file
+///
+/// The polygons that are added must have been placed at the locations of get_window_tile_locations () with the same
+/// arguments, by get_tiled_polygons (), get_tiled_polygon_soup () or visit_window_polygons (), so that their tile
+/// index gives their location.
+class scene_builder
+{
+    public:
+    /// @brief constructor
+    ///
+    /// @param rows rows in window
+    /// @param cols cols in window
+    /// @param origin center point of window
+    /// @param t the tile
+    /// @param scale scale of the tile
+    /// @param angle angle of the tile
+    scene_builder (const size_t rows, const size_t cols, const point &origin, const convex_uniform_tile &t, const double scale, const double angle)
+        : polys (t.get_polygons ())
+    {
+        if (polys.size () > 256)
+            throw std::runtime_error ("the tile has too many polygons for a scene file");
+        std::memset (&h, 0, sizeof (h));
+        std::memcpy (h.magic, scene_magic, sizeof (h.magic));
+        h.version = scene_version;
+        h.tiling = static_cast<uint32_t> (t.get_id ());
+        h.rows = rows;
+        h.cols = cols;
+        h.scale = scale;
+        h.angle = angle;
+        h.origin_x = origin.x;
+        h.origin_y = origin.y;
+        h.tile_width = t.get_width ();
+        h.tile_height = t.get_height ();
+        h.is_triangular = t.is_triangular ();
+        h.polygons = polys.size ();
+        for (const auto &p : polys)
+            h.vertices += p.size ();
+        // the lattice coordinates of each location
+        const lattice_rows l = get_window_lattice_rows (rows, cols, origin, scale * t.get_width (), scale * t.get_height (), angle, t.is_triangular (), get_tile_extent (polys, scale, angle));
+        for (const auto &i : l)
+            for (double k = i.k1; k <= i.k2; k += 1.0)
+                locations.push_back (std::make_pair (static_cast<int32_t> (k), static_cast<int32_t> (i.v)));
+    }
+    /// @brief add a polygon and its color
+    template<typename P>
+    void add (const P &p, const rgb8_pixel_t &m)
+    {
+        const size_t j = p.get_tile_index () / polys.size ();
+        assert (j < locations.size ());
+        assert (p.get_polygon_index () < polys.size ());
+        scene_instance s;
+        s.k = locations[j].first;
+        s.v = locations[j].second;
+        s.polygon_index = p.get_polygon_index ();
+        for (size_t i = 0; i < 3; ++i)
+            s.color[i] = m[i];
+        instances.push_back (s);
+    }
+    /// @brief get the number of instances
+    size_t size () const { return instances.size (); }
+    /// @brief write the scene file
+    void write (const std::string &fn) const
+    {
+        std::ofstream ofs (fn.c_str (), std::ios::binary);
+        if (!ofs)
+            throw std::runtime_error ("could not open file for writing");
+        scene_header hdr (h);
+        hdr.instances = instances.size ();
+        const scene_layout l = get_scene_layout (hdr);
+        ofs.write (reinterpret_cast<const char *> (&hdr), sizeof (hdr));
+        std::vector<uint32_t> offsets (1, 0);
+        for (const auto &p : polys)
+            offsets.push_back (offsets.back () + p.size ());
+        ofs.write (reinterpret_cast<const char *> (&offsets[0]), offsets.size () * sizeof (uint32_t));
+        const char pad[8] = { 0 };
+        ofs.write (pad, l.vertices - l.offsets - offsets.size () * sizeof (uint32_t));
+        for (const auto &p : polys)
+            for (const auto &i : p)
+                ofs.write (reinterpret_cast<const char *> (&i), sizeof (point));
+        ofs.write (reinterpret_cast<const char *> (instances.data ()), instances.size () * sizeof (scene_instance));
+        if (!ofs)
+            throw std::runtime_error ("could not write scene file");
+    }
+    private:
+    const polygons polys;
+    scene_header h;
+    std::vector<std::pair<int32_t,int32_t>> locations;
+    std::vector<scene_instance> instances;
+};
+
+/// @brief a scene file, mapped into memory
+///
+/// The instances are used in place, and pages of the file are only read when they are touched.
+class scene
+{
+    public:
+    explicit scene (const std::string &fn)
+    {
+        std::ifstream ifs (fn.c_str (), std::ios::binary);
+        if (!ifs)
+            throw std::runtime_error ("could not open file for reading");
+        scene_header h;
+        if (!ifs.read (reinterpret_cast<char *> (&h), sizeof (h)) || std::memcmp (h.magic, scene_magic, sizeof (h.magic)) != 0)
+            throw std::runtime_error ("not a scene file");
+        if (h.version != scene_version)
+            throw std::runtime_error ("unsupported scene file version");
+        if (h.polygons == 0 || h.polygons > 256)
+            throw std::runtime_error ("the scene file is corrupt");
+        ifs.close ();
+        const scene_layout l = get_scene_layout (h);
+        buf = map_file<unsigned char> (fn, 0, l.size);
+        hdr = reinterpret_cast<const scene_header *> (&buf[0]);
+        offsets = reinterpret_cast<const uint32_t *> (&buf[0] + l.offsets);
+        vertices = reinterpret_cast<const point *> (&buf[0] + l.vertices);
+        instances = reinterpret_cast<const scene_instance *> (&buf[0] + l.instances);
+        if (offsets[0] != 0 || offsets[h.polygons] != h.vertices)
+            throw std::runtime_error ("the scene file is corrupt");
+        for (size_t i = 0; i < h.polygons; ++i)
+            if (offsets[i + 1] < offsets[i])
+                throw std::runtime_error ("the scene file is corrupt");
+    }
+    const scene_header &get_header () const { return *hdr; }
+    /// @brief get the number of instances
+    size_t size () const { return hdr->instances; }
+    const scene_instance &operator[] (const size_t i) const
+    {
+        assert (i < size ());
+        return instances[i];
+    }
+    /// @brief get the tile's polygons, before they are scaled and rotated
+    polygons get_polygons () const
+    {
+        polygons p (hdr->polygons);
+        for (size_t i = 0; i < p.size (); ++i)
+        {
+            for (size_t j = offsets[i]; j < offsets[i + 1]; ++j)
+                p[i].push_back (vertices[j]);
+            p[i].set_tile_index (0);
+            p[i].set_polygon_index (i);
+        }
+        return p;
+    }
+    private:
+    buffer_container<unsigned char> buf;
+    const scene_header *hdr;
+    const uint32_t *offsets;
+    const point *vertices;
+    const scene_instance *instances;
+};
+
+/// @brief place the polygons of a scene's instances in a window of any size
+///
+/// The tiling is stretched to fill the window.  At the scene's own size, the polygons are the same as the ones that
+/// the scene was built from.  Instances can be placed in any order.
+class scene_placer
+{
+    public:
+    /// @brief constructor
+    ///
+    /// @param s the scene
+    /// @param rows rows in window
+    /// @param cols cols in window
+    scene_placer (const scene &s, const size_t rows, const size_t cols)
+        : s (s)
+        , polys (s.get_polygons ())
+    {
+        const scene_header &h = s.get_header ();
+        // the same transforms as visit_tile_locations () and get_tiled_polygons ()
+        lattice = translation (point (h.origin_x, h.origin_y)) * rotation (h.angle) * scaling (h.scale * h.tile_width, h.scale * h.tile_height);
+        m = rotation (h.angle) * scaling (h.scale, h.scale);
+        resized = rows != h.rows || cols != h.cols;
+        stretch = scaling (static_cast<double> (cols) / h.cols, static_cast<double> (rows) / h.rows);
+        odd_offset = h.is_triangular ? 0.5 : 0.0;
+    }
+    /// @brief get the polygon and the color of an instance
+    ///
+    /// @param i the instance
+    /// @param p the polygon, which is overwritten
+    /// @param c the color
+    void get (const size_t i, polygon &p, rgb8_pixel_t &c) const
+    {
+        const scene_instance &n = s[i];
+        if (n.polygon_index >= polys.size ())
+            throw std::runtime_error ("the scene file is corrupt");
+        const double v = n.v;
+        const double offset = (abs (n.v) & 1) * odd_offset;
+        const affine2 t = translation (lattice (point (n.k - offset, v))) * m;
+        p = polys[n.polygon_index];
+        transform (resized ? stretch * t : t, p);
+        p.set_tile_index (i);
+        for (size_t k = 0; k < 3; ++k)
+            c[k] = n.color[k];
+    }
+    private:
+    const scene &s;
+    const polygons polys;
+    affine2 lattice;
+    affine2 m;
+    bool resized;
+    affine2 stretch;
+    double odd_offset;
+};
+
+/// @brief visit the polygons of a scene, placed in a window of any size
+///
+/// @param s the scene
+/// @param rows rows in window
+/// @param cols cols in window
+/// @param f functor that is called with each polygon and its color
+///
+/// The tiling is stretched to fill the window.  At the scene's own size, the polygons are the same as the ones that
+/// the scene was built from.  The polygon that is passed to f is only valid until f returns.
+template<typename F>
+void visit_scene_polygons (const scene &s, const size_t rows, const size_t cols, F f)
+{
+    const scene_placer placer (s, rows, cols);
+    polygon p;
+    rgb8_pixel_t c;
+    for (size_t i = 0; i < s.size (); ++i)
+    {
+        placer.get (i, p, c);
+        f (static_cast<const polygon &> (p), static_cast<const rgb8_pixel_t &> (c));
+    }
+}
+
+/// @brief render a scene
+///
+/// @param s the scene
+/// @param img the image to paint, which may be any size
+template<typename T,typename Cont,typename Order>
+void render (const scene &s, image<T,3,Cont,Order> &img)
+{
+    const rect window (0, 0, img.cols (), img.rows ());
+    scanlines a;
+    scanlines b;
+    visit_scene_polygons (s, img.rows (), img.cols (), [&] (const polygon &p, const rgb8_pixel_t &c)
+    {
+        a.clear ();
+        get_convex_polygon_scanlines (p, a);
+        b.clear ();
+        clip (a, window, b);
+        const span_filler<image<T,3,Cont,Order>> f (img, c);
+        for (const auto &j : b)
+            f.fill (img, j);
+    });
+}
+
+/// @brief paint the rows of a rendered scene one at a time, without an image
+///
+/// Each row is the same as the corresponding row of an image that render () painted.  The instances are sorted by the
+/// first row that they might cover.  An instance is only placed and rasterized when that row is painted, and its
+/// scanlines are dropped after its last row, so besides the active polygons, only two numbers per instance are kept.
+/// The rows must be painted from top to bottom.
+class scene_row_painter
+{
+    public:
+    /// @brief constructor
+    ///
+    /// @param s the scene
+    /// @param rows rows in the image
+    /// @param cols cols in the image
+    scene_row_painter (const scene &s, const size_t rows, const size_t cols)
+        : placer (s, rows, cols)
+        , cols (cols)
+        , window (0, 0, cols, rows)
+        , next (0)
+        , y (0)
+    {
+        rgb8_pixel_t c;
+        for (size_t i = 0; i < s.size (); ++i)
+        {
+            placer.get (i, p, c);
+            if (p.empty ())
+                continue;
+            const rectf r = get_bounding_rectf (p);
+            // starting early does no harm, so round down
+            if (r.maxy < 0.0 || r.miny >= rows)
+                continue;
+            starts.push_back (std::make_pair (static_cast<uint32_t> (std::max (0.0, ::floor (r.miny))), static_cast<uint32_t> (i)));
+        }
+        std::sort (starts.begin (), starts.end ());
+    }
+    /// @brief paint the next row
+    ///
+    /// @param dst cols interlaced RGB pixels
+    void paint (unsigned char *dst)
+    {
+        std::memset (dst, 0, cols * 3);
+        // place the instances that start on this row, keeping the active ones in painting order
+        const size_t n = active.size ();
+        for (; next < starts.size () && starts[next].first <= y; ++next)
+        {
+            active.push_back (active_polygon ());
+            active_polygon &a = active.back ();
+            a.i = starts[next].second;
+            a.cursor = 0;
+            placer.get (a.i, p, a.color);
+            s.clear ();
+            get_convex_polygon_scanlines (p, s);
+            clip (s, window, a.s);
+        }
+        if (active.size () != n)
+        {
+            const auto by_instance = [] (const active_polygon &a, const active_polygon &b) { return a.i < b.i; };
+            std::sort (active.begin () + n, active.end (), by_instance);
+            std::inplace_merge (active.begin (), active.begin () + n, active.end (), by_instance);
+        }
+        size_t k = 0;
+        for (size_t i = 0; i < active.size (); ++i)
+        {
+            active_polygon &a = active[i];
+            while (a.cursor < a.s.size () && a.s[a.cursor].y < static_cast<int> (y))
+                ++a.cursor;
+            if (a.cursor < a.s.size () && a.s[a.cursor].y == static_cast<int> (y))
+            {
+                const unsigned char q[3] = { a.color[0], a.color[1], a.color[2] };
+                const pixel_pattern<3> f (q);
+                for (; a.cursor < a.s.size () && a.s[a.cursor].y == static_cast<int> (y); ++a.cursor)
+                    f.fill (dst + a.s[a.cursor].x * 3, a.s[a.cursor].len);
+            }
+            // keep the polygon if it has more rows
+            if (a.cursor < a.s.size ())
+            {
+                if (k != i)
+                    active[k] = std::move (a);
+                ++k;
+            }
+        }
+        active.resize (k);
+        ++y;
+    }
+    private:
+    struct active_polygon
+    {
+        uint32_t i;
+        uint32_t cursor;
+        rgb8_pixel_t color;
+        scanlines s;
+    };
+    const scene_placer placer;
+    const size_t cols;
+    const rect window;
+    std::vector<std::pair<uint32_t,uint32_t>> starts;
+    size_t next;
+    size_t y;
+    std::vector<active_polygon> active;
+    polygon p;
+    scanlines s;
+};
+
+} // namespace image_tiler
+
+#endif // SCENE_H
@@ -0,0 +1,249 @@
+/// @file stats.h
+/// @brief region statistics
+/// @author Jeff Perry <jeffsp@gmail.com>
+/// @version 1.0
+/// @date 2014-07-27
+
+#ifndef STATS_H
+#define STATS_H
+
+#include "graphics.h"
+#include "image.h"
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace image_tiler
+{
+
+/// @brief statistics that may be requested in addition to the mean
+enum region_stats_flags
+{
+    stats_mean = 0x0,
+    stats_variance = 0x1,
+    stats_minmax = 0x2,
+    stats_median = 0x4,
+    stats_all = 0x7
+};
+
+/// @brief per channel statistics of the pixels covered by a set of scanlines
+///
+/// Fields that were not requested are left zeroed.
+template<size_t CHANNELS>
+struct region_stats
+{
+    region_stats ()
+        : count (0)
+    {
+        mean.fill (0);
+        variance.fill (0.0);
+        min.fill (0);
+        max.fill (0);
+        median.fill (0);
+    }
+    size_t count;
+    std::array<unsigned,CHANNELS> mean;
+    std::array<double,CHANNELS> variance;
+    std::array<unsigned,CHANNELS> min;
+    std::array<unsigned,CHANNELS> max;
+    std::array<unsigned,CHANNELS> median;
+};
+
+/// @brief get statistics for a region in a single pass
+///
+/// @param img the image
+/// @param s scanlines that cover the region
+/// @param flags bitwise or of region_stats_flags
+///
+/// @return the region statistics
+///
+/// Each scanline is walked once, and all channels are accumulated together.  The mean is rounded exactly the same way
+/// as get_mean().  The median uses a 256 bin histogram, so it is only available for 8 bit images.
+template<typename T,size_t CHANNELS,typename Cont,typename Order>
+region_stats<CHANNELS> get_region_stats (const image<T,CHANNELS,Cont,Order> &img, const scanlines &s, const unsigned flags = stats_mean)
+{
+    region_stats<CHANNELS> r;
+    if (s.empty ())
+        return r;
+    std::array<uint64_t,CHANNELS> sum;
+    sum.fill (0);
+    if (flags == stats_mean)
+    {
+        // fast path: only sums are needed
+        for (const auto &i : s)
+        {
+            const T *p = &img[img.index (i.y, i.x, 0) - Order::channel (0)];
+            for (unsigned x = 0; x < i.len; ++x, p += CHANNELS)
+                for (size_t k = 0; k < CHANNELS; ++k)
+                    sum[k] += p[k];
+            r.count += i.len;
+        }
+    }
+    else
+    {
+        assert (!(flags & stats_median) || sizeof (T) == 1);
+        std::array<uint64_t,CHANNELS> sum2;
+        sum2.fill (0);
+        std::array<T,CHANNELS> mn;
+        std::array<T,CHANNELS> mx;
+        mn.fill (std::numeric_limits<T>::max ());
+        mx.fill (std::numeric_limits<T>::lowest ());
+        std::vector<size_t> hist ((flags & stats_median) ? 256 * CHANNELS : 0);
+        for (const auto &i : s)
+        {
+            const T *p = &img[img.index (i.y, i.x, 0) - Order::channel (0)];
+            for (unsigned x = 0; x < i.len; ++x, p += CHANNELS)
+            {
+                for (size_t k = 0; k < CHANNELS; ++k)
+                {
+                    const T v = p[k];
+                    sum[k] += v;
+                    sum2[k] += static_cast<uint64_t> (v) * v;
+                    if (v < mn[k])
+                        mn[k] = v;
+                    if (v > mx[k])
+                        mx[k] = v;
+                    if (!hist.empty ())
+                        ++hist[k * 256 + v];
+                }
+            }
+            r.count += i.len;
+        }
+        for (size_t k = 0; k < CHANNELS; ++k)
+        {
+            // sums are in storage order
+            const size_t j = Order::channel (k);
+            if (flags & stats_variance)
+            {
+                const double m = static_cast<double> (sum[j]) / r.count;
+                r.variance[k] = std::max (0.0, static_cast<double> (sum2[j]) / r.count - m * m);
+            }
+            if (flags & stats_minmax)
+            {
+                r.min[k] = mn[j];
+                r.max[k] = mx[j];
+            }
+            if (flags & stats_median)
+            {
+                // the lower median
+                const size_t half = (r.count + 1) / 2;
+                size_t total = 0;
+                size_t v = 0;
+                for (; v < 255; ++v)
+                {
+                    total += hist[j * 256 + v];
+                    if (total >= half)
+                        break;
+                }
+                r.median[k] = v;
+            }
+        }
+    }
+    if (r.count == 0)
+        return r;
+    for (size_t k = 0; k < CHANNELS; ++k)
+        r.mean[k] = ::round (static_cast<double> (sum[Order::channel (k)]) / r.count);
+    return r;
+}
+
+/// @brief get statistics for many regions
+///
+/// @param img the image
+/// @param ps one set of scanlines for each region
+/// @param flags bitwise or of region_stats_flags
+///
+/// @return one set of statistics for each region
+template<typename T,size_t CHANNELS,typename Cont,typename Order>
+std::vector<region_stats<CHANNELS>> get_region_stats (const image<T,CHANNELS,Cont,Order> &img, const std::vector<scanlines> &ps, const unsigned flags = stats_mean)
+{
+    std::vector<region_stats<CHANNELS>> r (ps.size ());
+#pragma omp parallel for schedule (dynamic, 256)
+    for (size_t i = 0; i < ps.size (); ++i)
+        r[i] = get_region_stats (img, ps[i], flags);
+    return r;
+}
+
+/// @brief running sums along each row of an 8 bit image
+///
+/// The sum of the pixels in a scanline is the difference of two entries, so region means can be computed in time that
+/// depends on the number of scanlines, not on the number of pixels.  This pays off when the same image is tiled many
+/// times.  Each pixel takes 4 bytes per channel.
+template<size_t CHANNELS>
+class row_sums
+{
+    public:
+    template<typename T,typename Cont,typename Order>
+    explicit row_sums (const image<T,CHANNELS,Cont,Order> &img)
+        : rows_ (img.rows ()), cols_ (img.cols ()), sums_ (img.rows () * (img.cols () + 1) * CHANNELS)
+    {
+        static_assert (sizeof (T) == 1, "row sums are only supported for 8 bit images");
+        if (cols_ > std::numeric_limits<uint32_t>::max () / 255)
+            throw std::runtime_error ("the image is too wide for row sums");
+#pragma omp parallel for
+        for (size_t r = 0; r < rows_; ++r)
+        {
+            uint32_t *q = row (r);
+            for (size_t c = 0; c < cols_; ++c, q += CHANNELS)
+                for (size_t k = 0; k < CHANNELS; ++k)
+                    q[CHANNELS + k] = q[k] + img (r, c, k);
+        }
+    }
+    size_t rows () const { return rows_; }
+    size_t cols () const { return cols_; }
+    /// @brief get the sum of channel k of the pixels in [0, c) of row r
+    uint32_t operator() (const size_t r, const size_t c, const size_t k) const
+    { return sums_[(r * (cols_ + 1) + c) * CHANNELS + k]; }
+    private:
+    uint32_t *row (const size_t r)
+    { return &sums_[r * (cols_ + 1) * CHANNELS]; }
+    size_t rows_;
+    size_t cols_;
+    std::vector<uint32_t> sums_;
+};
+
+/// @brief get the mean of a region from row sums
+///
+/// @param rs the row sums
+/// @param s scanlines that cover the region
+///
+/// @return the region statistics, with only the count and mean filled in
+///
+/// The result is identical to get_region_stats (img, s).
+template<size_t CHANNELS>
+region_stats<CHANNELS> get_region_stats (const row_sums<CHANNELS> &rs, const scanlines &s)
+{
+    region_stats<CHANNELS> r;
+    std::array<uint64_t,CHANNELS> sum;
+    sum.fill (0);
+    for (const auto &i : s)
+    {
+        for (size_t k = 0; k < CHANNELS; ++k)
+            sum[k] += rs (i.y, i.x + i.len, k) - rs (i.y, i.x, k);
+        r.count += i.len;
+    }
+    if (r.count == 0)
+        return r;
+    for (size_t k = 0; k < CHANNELS; ++k)
+        r.mean[k] = ::round (static_cast<double> (sum[k]) / r.count);
+    return r;
+}
+
+/// @brief get the means of many regions from row sums
+template<size_t CHANNELS>
+std::vector<region_stats<CHANNELS>> get_region_stats (const row_sums<CHANNELS> &rs, const std::vector<scanlines> &ps)
+{
+    std::vector<region_stats<CHANNELS>> r (ps.size ());
+#pragma omp parallel for schedule (dynamic, 256)
+    for (size_t i = 0; i < ps.size (); ++i)
+        r[i] = get_region_stats (rs, ps[i]);
+    return r;
+}
+
+} // namespace image_tiler
+
+#endif // STATS_H
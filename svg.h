@@ -0,0 +1,157 @@
+/// @file svg.h
+/// @brief write tiled images as svg files
+/// @author Jeff Perry <jeffsp@gmail.com>
+/// @version 1.0
+/// @date 2014-07-27
+
+#ifndef SVG_H
+#define SVG_H
+
+#include "geometry.h"
+#include "image_elements.h"
+#include "raster_cache.h"
+#include "tiles.h"
+#include <cassert>
+#include <fstream>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace image_tiler
+{
+
+/// @brief write the opening tag of an svg file
+void write_svg_header (std::ostream &s, const size_t w, const size_t h)
+{
+    s << "<svg currentScale=\"1.0\" width=\"" << w << "\" height=\"" << h << "\" viewBox=\"0 0 " << w << " " << h << "\">" << std::endl;
+}
+
+/// @brief get a color as '#rrggbb'
+std::string get_svg_color (const rgb8_pixel_t &m)
+{
+    std::stringstream color;
+    color << "#"
+        << std::hex
+        << std::setfill ('0') << std::setw (2) << static_cast<int> (m[0])
+        << std::setfill ('0') << std::setw (2) << static_cast<int> (m[1])
+        << std::setfill ('0') << std::setw (2) << static_cast<int> (m[2]);
+    return color.str ();
+}
+
+/// @brief write a filled polygon
+template<typename P>
+void write_svg_polygon (std::ostream &s, const P &p, const rgb8_pixel_t &m)
+{
+    s << "<polygon points=\"";
+    for (const auto &j : p)
+        s << " " << j.x << ',' << j.y;
+    const std::string color = get_svg_color (m);
+    s << "\" style=\"stroke:"
+        << color
+        << ";stroke-width:1px;fill:"
+        << color
+        << ";\" />"
+        << std::endl;
+}
+
+/// @brief write the closing tag of an svg file
+void write_svg_footer (std::ostream &s)
+{
+    s << "Sorry, your browser does not support inline SVG." << std::endl;
+    s << "</svg>" << std::endl;
+}
+
+/// @brief write each element as a polygon
+void write_svg (std::ostream &s, const size_t w, const size_t h, const image_elements &e)
+{
+    write_svg_header (s, w, h);
+    for (size_t i = 0; i < e.size (); ++i)
+        write_svg_polygon (s, e.p[i], e.m[i]);
+    write_svg_footer (s);
+}
+
+/// @brief write each element as a polygon
+void write_svg (const std::string &fn, const size_t w, const size_t h, const image_elements &e)
+{
+    std::ofstream ofs (fn.c_str ());
+    if (!ofs)
+        throw std::runtime_error ("could not open file for writing");
+    write_svg (ofs, w, h, e);
+}
+
+/// @brief write svg files that define each of the tile's polygons once, where every element is a reference to one of them
+///
+/// The definitions are scaled but not rotated, and the rotation is applied once to the group that contains the
+/// references, so each reference only needs the tile's location in the rotated frame and a color.  The definitions
+/// are filled and stroked with the color of the reference that uses them.
+class svg_instances
+{
+    public:
+    svg_instances (const convex_uniform_tile &t, double scale, double angle)
+        : prototypes (get_prototype_polygons (t.get_polygons (), scale, angle))
+        , shapes (get_prototype_polygons (t.get_polygons (), scale, 0.0))
+        , unrotate (rotation (-angle))
+        , angle (angle)
+    {
+    }
+    void write_header (std::ostream &s, const size_t w, const size_t h) const
+    {
+        write_svg_header (s, w, h);
+        s << "<defs>" << std::endl;
+        for (size_t i = 0; i < shapes.size (); ++i)
+        {
+            s << "<polygon id=\"p" << i << "\" points=\"";
+            for (const auto &j : shapes[i])
+                s << " " << j.x << ',' << j.y;
+            s << "\" style=\"stroke:currentColor;stroke-width:1px;fill:currentColor;\" />" << std::endl;
+        }
+        s << "</defs>" << std::endl;
+        s << "<g transform=\"rotate(" << angle << ")\">" << std::endl;
+    }
+    template<typename P>
+    void write_polygon (std::ostream &s, const P &p, const rgb8_pixel_t &m) const
+    {
+        const size_t k = p.get_polygon_index ();
+        assert (k < prototypes.size ());
+        if (p.empty ())
+            return;
+        // the polygon is a translated prototype, get the translation before it was rotated
+        const point o = unrotate (point (p[0].x - prototypes[k][0].x, p[0].y - prototypes[k][0].y));
+        s << "<use href=\"#p" << k << "\" x=\"" << o.x << "\" y=\"" << o.y << "\" color=\"" << get_svg_color (m) << "\" />" << std::endl;
+    }
+    void write_footer (std::ostream &s) const
+    {
+        s << "</g>" << std::endl;
+        write_svg_footer (s);
+    }
+    private:
+    const polygons prototypes;
+    const polygons shapes;
+    const affine2 unrotate;
+    const double angle;
+};
+
+/// @brief write each element as a reference to one of the tile's polygons
+void write_instanced_svg (std::ostream &s, const size_t w, const size_t h, const convex_uniform_tile &t, double scale, double angle, const image_elements &e)
+{
+    const svg_instances si (t, scale, angle);
+    si.write_header (s, w, h);
+    for (size_t i = 0; i < e.size (); ++i)
+        si.write_polygon (s, e.p[i], e.m[i]);
+    si.write_footer (s);
+}
+
+/// @brief write each element as a reference to one of the tile's polygons
+void write_instanced_svg (const std::string &fn, const size_t w, const size_t h, const convex_uniform_tile &t, double scale, double angle, const image_elements &e)
+{
+    std::ofstream ofs (fn.c_str ());
+    if (!ofs)
+        throw std::runtime_error ("could not open file for writing");
+    write_instanced_svg (ofs, w, h, t, scale, angle, e);
+}
+
+} // namespace image_tiler
+
+#endif // SVG_H
@@ -0,0 +1,87 @@
+/// @file swizzle.h
+/// @brief convert between RGB and BGR pixel layouts
+/// @author Jeff Perry <jeffsp@gmail.com>
+/// @version 1.0
+/// @date 2014-07-27
+
+#ifndef SWIZZLE_H
+#define SWIZZLE_H
+
+#include <cstddef>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace image_tiler
+{
+
+/// @brief swap the first and third channels of interlaced 3 channel pixels, one pixel at a time
+///
+/// @param src source pixels
+/// @param dst destination pixels, which may be the same as src
+/// @param pixels number of pixels
+void swap_rb_scalar (const unsigned char *src, unsigned char *dst, const size_t pixels)
+{
+    for (size_t i = 0; i < pixels; ++i, src += 3, dst += 3)
+    {
+        const unsigned char r = src[0];
+        const unsigned char g = src[1];
+        const unsigned char b = src[2];
+        dst[0] = b;
+        dst[1] = g;
+        dst[2] = r;
+    }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+/// @brief swap the first and third channels of interlaced 3 channel pixels with SSSE3 shuffles
+///
+/// @param src source pixels
+/// @param dst destination pixels, which may be the same as src
+/// @param pixels number of pixels
+///
+/// Each 16 byte load holds five whole pixels and one extra byte.  The shuffle leaves the extra byte in place, and only
+/// the 15 bytes of whole pixels are consumed on each step, so the next load rereads the extra byte before it is
+/// overwritten.  This makes the kernel safe to run in place.
+__attribute__ ((target ("ssse3")))
+void swap_rb_ssse3 (const unsigned char *src, unsigned char *dst, size_t pixels)
+{
+    const __m128i mask = _mm_setr_epi8 (2, 1, 0, 5, 4, 3, 8, 7, 6, 11, 10, 9, 14, 13, 12, 15);
+    // keep one pixel in reserve so that the 16 byte load and store never run past the end
+    while (pixels >= 6)
+    {
+        const __m128i a = _mm_loadu_si128 (reinterpret_cast<const __m128i *> (src));
+        _mm_storeu_si128 (reinterpret_cast<__m128i *> (dst), _mm_shuffle_epi8 (a, mask));
+        src += 15;
+        dst += 15;
+        pixels -= 5;
+    }
+    swap_rb_scalar (src, dst, pixels);
+}
+
+#endif
+
+/// @brief swap the first and third channels of interlaced 3 channel pixels
+///
+/// @param src source pixels
+/// @param dst destination pixels, which may be the same as src
+/// @param pixels number of pixels
+///
+/// This converts between RGB and BGR.  A vectorized kernel is used when the processor supports it.
+void swap_rb (const unsigned char *src, unsigned char *dst, const size_t pixels)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    static const bool has_ssse3 = __builtin_cpu_supports ("ssse3");
+    if (has_ssse3)
+    {
+        swap_rb_ssse3 (src, dst, pixels);
+        return;
+    }
+#endif
+    swap_rb_scalar (src, dst, pixels);
+}
+
+} // namespace image_tiler
+
+#endif // SWIZZLE_H
@@ -0,0 +1,188 @@
+/// @file test_async_preview.cc
+/// @brief test background rendering of previews
+/// @author Jeff Perry <jeffsp@gmail.com>
+/// @version 1.0
+/// @date 2014-07-27
+
+#include "async_preview.h"
+#include "verify.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+using namespace image_tiler;
+using namespace std;
+
+rgb8_image_t random_image (const size_t rows, const size_t cols)
+{
+    rgb8_image_t img (rows, cols);
+    for (size_t i = 0; i < img.size (); ++i)
+        img[i] = rand () % 256;
+    return img;
+}
+
+// wait for the exact frame of a request
+rgb8_image_t wait_for (async_preview<rgb8_image_t> &pv, const size_t g, size_t *coarse_frames = nullptr)
+{
+    rgb8_image_t img;
+    size_t h = 0;
+    bool exact = false;
+    for (size_t i = 0; i < 10000; ++i)
+    {
+        if (pv.get_frame (img, h, exact))
+        {
+            // frames are never older than ones that have already been taken
+            VERIFY (h <= g);
+            if (!exact && coarse_frames != nullptr)
+                ++*coarse_frames;
+            if (h == g && exact)
+                return img;
+        }
+        this_thread::sleep_for (chrono::milliseconds (1));
+    }
+    throw runtime_error ("timed out");
+}
+
+void test1 ()
+{
+    // only the latest request has to be rendered, and it is the same as rendering in the foreground
+    const rgb8_image_t original = random_image (211, 307);
+    const tile_list tl = create_tile_list ();
+    async_preview<rgb8_image_t> pv (original, tl);
+    preview<rgb8_image_t> expected (original, tl);
+    preview_params p;
+    p.scale = 6.0;
+    size_t g = 0;
+    for (size_t i = 0; i < 20; ++i)
+    {
+        p.angle += 1.0;
+        g = pv.request (p);
+    }
+    expected.set_params (p);
+    VERIFY (wait_for (pv, g) == expected.get_image ());
+    // no frame is ready until there is another request
+    rgb8_image_t img;
+    size_t h;
+    VERIFY (!pv.get_frame (img, h));
+    p.outline = true;
+    g = pv.request (p);
+    expected.set_params (p);
+    VERIFY (wait_for (pv, g) == expected.get_image ());
+}
+
+void test2 ()
+{
+    // destroying a busy preview cancels its work
+    const rgb8_image_t original = random_image (500, 500);
+    const tile_list tl = create_tile_list ();
+    async_preview<rgb8_image_t> pv (original, tl);
+    preview_params p;
+    p.scale = 2.0;
+    pv.request (p);
+}
+
+void test3 ()
+{
+    // large images get a coarse frame first
+    const rgb8_image_t original = random_image (400, 300);
+    const tile_list tl = create_tile_list ();
+    async_preview<rgb8_image_t> pv (original, tl, 10000);
+    preview<rgb8_image_t> expected (original, tl);
+    preview_params p;
+    p.scale = 20.0;
+    p.outline = true;
+    size_t g = pv.request (p);
+    size_t coarse_frames = 0;
+    expected.set_params (p);
+    VERIFY (wait_for (pv, g, &coarse_frames) == expected.get_image ());
+    // the exact frame may replace the coarse one before it is taken, but it was finished
+    VERIFY (coarse_frames <= 1);
+    VERIFY (pv.get_coarse_frames () == 1);
+    // changes that only recomposite the exact frame skip the coarse one
+    p.outline = false;
+    p.transparency = 30;
+    g = pv.request (p);
+    expected.set_params (p);
+    VERIFY (wait_for (pv, g) == expected.get_image ());
+    VERIFY (pv.get_coarse_frames () == 1);
+    // moving the tiling does not
+    p.angle = 10.0;
+    g = pv.request (p);
+    expected.set_params (p);
+    VERIFY (wait_for (pv, g) == expected.get_image ());
+    VERIFY (pv.get_coarse_frames () == 2);
+    // neither does drawing the outlines of the new tiling, but showing them again does
+    for (auto outline : { true, false, true })
+    {
+        p.outline = outline;
+        g = pv.request (p);
+        expected.set_params (p);
+        VERIFY (wait_for (pv, g) == expected.get_image ());
+        VERIFY (pv.get_coarse_frames () == 3);
+    }
+    VERIFY (get_shrink_factor (400, 300, 10000) == 4);
+    VERIFY (get_shrink_factor (400, 300, 120000) == 1);
+}
+
+void test4 ()
+{
+    // shrinking and enlarging
+    rgb8_image_t a (5, 3);
+    for (size_t i = 0; i < a.size (); ++i)
+        a[i] = i;
+    const rgb8_image_t b = shrink (a, 2);
+    VERIFY (b.rows () == 3);
+    VERIFY (b.cols () == 2);
+    // the mean of rows 0 and 1, cols 0 and 1, channel 0 is (0 + 3 + 9 + 12) / 4
+    VERIFY (b (0, 0, 0) == 6);
+    // a partial block
+    VERIFY (b (2, 1, 2) == a (4, 2, 2));
+    rgb8_image_t c (5, 3);
+    enlarge (b, 2, c);
+    VERIFY (c (1, 1, 1) == b (0, 0, 1));
+    VERIFY (c (4, 2, 0) == b (2, 1, 0));
+    VERIFY (shrink (a, 1) == a);
+}
+
+void test5 ()
+{
+    // coarse tiles are made larger when they would give too many polygons
+    const rgb8_image_t small = random_image (150, 200);
+    const tile_list tl = create_tile_list ();
+    const size_t polygons = 300;
+    for (size_t i = 0; i < tl.size (); ++i)
+    {
+        const double s = get_coarse_scale (1.0, 4, small.size () / 3, tl[i], polygons);
+        VERIFY (s > 0.25);
+        // the estimate ignores the partial tiles around the edges
+        preview<rgb8_image_t> pv (small, tl);
+        preview_params p;
+        p.tile_index = i;
+        p.scale = s;
+        pv.set_params (p);
+        VERIFY (pv.get_elements ().size () < 2 * polygons);
+        // large tiles are left alone
+        VERIFY (get_coarse_scale (400.0, 4, small.size () / 3, tl[i], polygons) == 100.0);
+    }
+}
+
+int main ()
+{
+    try
+    {
+        test1 ();
+        test2 ();
+        test3 ();
+        test4 ();
+        test5 ();
+
+        return 0;
+    }
+    catch (const exception &e)
+    {
+        cerr << e.what () << endl;
+        return -1;
+    }
+}
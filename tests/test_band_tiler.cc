@@ -0,0 +1,71 @@
+/// @file test_band_tiler.cc
+/// @brief test band tiler functionality
+/// @author Jeff Perry <jeffsp@gmail.com>
+/// @version 1.0
+/// @date 2014-07-27
+
+#include "band_tiler.h"
+#include "graphics.h"
+#include "image.h"
+#include "image_elements.h"
+#include "tile_visitor.h"
+#include "tiler.h"
+#include "tiles.h"
+#include "verify.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+
+using namespace image_tiler;
+using namespace std;
+
+rgb8_image_t random_image (const size_t rows, const size_t cols)
+{
+    rgb8_image_t img (rows, cols);
+    for (size_t i = 0; i < img.size (); ++i)
+        img[i] = rand () % 256;
+    return img;
+}
+
+void test1 ()
+{
+    // the output does not depend on the band height
+    const rgb8_image_t img = random_image (203, 301);
+    const tile_list tl = create_tile_list ();
+    for (size_t i = 0; i < tl.size (); ++i)
+    {
+        const auto &t = tl[i];
+        const double scale = 5.0 + i;
+        const double angle = 10.0 * i;
+        polygons p;
+        visit_window_polygons (img.rows (), img.cols (), point (img.cols () / 2.0, img.rows () / 2.0), t, scale, angle, [&] (const polygon &q) { p.push_back (q); });
+        // process the whole image at once
+        const image_elements e = get_image_elements (img, p);
+        rgb8_image_t a (img.rows (), img.cols ());
+        fill (a, e.s, e.m);
+        for (auto band_rows : { 1, 7, 64, 1000 })
+        {
+            image_band_reader src (img);
+            rgb8_image_t b (img.rows (), img.cols ());
+            image_band_writer dst (b);
+            VERIFY (tile_bands (src, dst, t, scale, angle, band_rows) == p.size ());
+            VERIFY (equal (a.begin (), a.end (), b.begin ()));
+        }
+    }
+}
+
+int main ()
+{
+    try
+    {
+        test1 ();
+
+        return 0;
+    }
+    catch (const exception &e)
+    {
+        cerr << e.what () << endl;
+        return -1;
+    }
+}
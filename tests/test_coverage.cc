@@ -0,0 +1,224 @@
+/// @file test_coverage.cc
+/// @brief test anti-aliased rasterization
+/// @author Jeff Perry <jeffsp@gmail.com>
+/// @version 1.0
+/// @date 2014-07-27
+
+#include "coverage.h"
+#include "tiler.h"
+#include "tiles.h"
+#include "verify.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+using namespace image_tiler;
+using namespace std;
+
+// sum the coverage of each pixel
+vector<double> get_coverage_sums (const size_t rows, const size_t cols, const polygon_coverage &c)
+{
+    vector<double> sums (rows * cols);
+    for (const auto &i : c)
+    {
+        for (const auto &j : i.full)
+            for (unsigned x = 0; x < j.len; ++x)
+                sums[j.y * cols + j.x + x] += 1.0;
+        for (const auto &j : i.edges)
+        {
+            VERIFY (j.a > 0.0 && j.a <= 1.0);
+            sums[j.y * cols + j.x] += j.a;
+        }
+    }
+    return sums;
+}
+
+double get_total (const coverage &c)
+{
+    double a = 0.0;
+    for (const auto &i : c.full)
+        a += i.len;
+    for (const auto &i : c.edges)
+        a += i.a;
+    return a;
+}
+
+void test1 ()
+{
+    // polygons on pixel boundaries have no edges
+    const rect window (0, 0, 100, 100);
+    coverage c;
+    get_convex_polygon_coverage (polygon { point (10, 20), point (30, 20), point (30, 25), point (10, 25) }, window, c);
+    VERIFY (c.edges.empty ());
+    VERIFY (c.full.size () == 5);
+    for (size_t i = 0; i < c.full.size (); ++i)
+        VERIFY (c.full[i] == scanline (20 + i, 10, 20));
+    // half pixels
+    c.clear ();
+    get_convex_polygon_coverage (polygon { point (10.5, 20), point (12, 20), point (12, 21), point (10.5, 21) }, window, c);
+    VERIFY (c.full.size () == 1);
+    VERIFY (c.full[0] == scanline (20, 11, 1));
+    VERIFY (c.edges.size () == 1);
+    VERIFY (c.edges[0].y == 20 && c.edges[0].x == 10 && c.edges[0].a == 0.5f);
+    // the coverage is the area
+    c.clear ();
+    const polygon p { point (3.3, 4.1), point (40.7, 9.9), point (21.2, 33.6) };
+    get_convex_polygon_coverage (p, window, c);
+    const double area = ::fabs ((p[1].x - p[0].x) * (p[2].y - p[0].y) - (p[2].x - p[0].x) * (p[1].y - p[0].y)) / 2.0;
+    VERIFY (::fabs (get_total (c) - area) < 1e-3);
+    // only pixels in the window are returned
+    c.clear ();
+    get_convex_polygon_coverage (p, rect (0, 0, 20, 10), c);
+    for (const auto &i : c.full)
+        VERIFY (i.y >= 0 && i.y < 10 && i.x >= 0 && i.x + i.len <= 20);
+    for (const auto &i : c.edges)
+        VERIFY (i.y >= 0 && i.y < 10 && i.x >= 0 && i.x < 20);
+}
+
+void test2 ()
+{
+    // polygons that are smaller than a pixel have no scanlines, but they still cover something
+    const polygon p { point (5.1, 5.1), point (5.4, 5.2), point (5.3, 5.4) };
+    VERIFY (get_convex_polygon_scanlines (p).empty ());
+    coverage c;
+    get_convex_polygon_coverage (p, rect (0, 0, 10, 10), c);
+    VERIFY (c.full.empty ());
+    VERIFY (c.edges.size () == 1);
+    rgb8_image_t img (10, 10);
+    img.assign (100);
+    const auto st = get_region_stats (img, c);
+    VERIFY (st.count == 1);
+    for (size_t k = 0; k < 3; ++k)
+        VERIFY (st.mean[k] == 100);
+}
+
+void test3 ()
+{
+    // the polygons of a tiling that cover a window cover every pixel at least once
+    const tile_list tl = create_tile_list ();
+    const size_t w = 97;
+    const size_t h = 61;
+    for (const auto &t : tl)
+    {
+        // the polygons of some tiles overlap, and the rest cover every pixel exactly once
+        double area = 0.0;
+        for (const auto &p : t.get_polygons ())
+            area += get_area (vector<point> (p.begin (), p.end ()));
+        const bool overlaps = ::fabs (area - t.get_width () * t.get_height ()) > 1e-6;
+        for (auto scale : { 0.7, 3.0, 11.0 })
+        {
+            const double angle = 17.0;
+            const auto locs = get_window_tile_locations (h, w, point (w / 2.0, h / 2.0), scale * t.get_width (), scale * t.get_height (), angle, t.is_triangular (), get_tile_extent (t.get_polygons (), scale, angle));
+            const auto p = get_covering_polygons (w, h, get_tiled_polygon_soup (locs, t.get_polygons (), scale, angle));
+            const polygon_coverage c = get_polygon_coverage (h, w, p);
+            VERIFY (c.size () == p.size ());
+            // the vertices of some tiles are rounded, so neighbors do not quite meet
+            for (const auto &i : get_coverage_sums (h, w, c))
+                VERIFY (i > 1.0 - 1e-2 && (overlaps || i < 1.0 + 1e-2));
+            // so a single color comes back out, even where later polygons are painted over earlier ones
+            rgb8_image_t img (h, w);
+            fill (img, c, vector<rgb8_pixel_t> (c.size (), rgb8_pixel_t { 10, 128, 255 }));
+            for (size_t i = 0; i < img.rows (); ++i)
+            {
+                for (size_t j = 0; j < img.cols (); ++j)
+                {
+                    VERIFY (abs (img (i, j, 0) - 10) <= 2);
+                    VERIFY (abs (img (i, j, 1) - 128) <= 2);
+                    VERIFY (img (i, j, 2) >= 253);
+                }
+            }
+        }
+    }
+}
+
+void test4 ()
+{
+    // without edges, the means are the same as the means of the scanlines
+    rgb8_image_t img (30, 40);
+    for (size_t i = 0; i < img.size (); ++i)
+        img[i] = (i * 37) % 256;
+    coverage c;
+    get_convex_polygon_coverage (polygon { point (3, 2), point (35, 2), point (35, 27), point (3, 27) }, rect (0, 0, 40, 30), c);
+    VERIFY (c.edges.empty ());
+    VERIFY (get_region_stats (img, c).mean == get_region_stats (img, c.full).mean);
+    // edges are weighted by their coverage
+    c.clear ();
+    c.full.push_back (scanline (0, 0, 1));
+    c.edges.push_back (edge_pixel (0, 1, 0.5f));
+    const auto st = get_region_stats (img, c);
+    VERIFY (st.count == 2);
+    for (size_t k = 0; k < 3; ++k)
+        VERIFY (st.mean[k] == ::round ((img (0, 0, k) + 0.5 * img (0, 1, k)) / 1.5));
+}
+
+void test5 ()
+{
+    // painting a row at a time gives the same rows as filling an image, even where polygons overlap
+    const tile_list tl = create_tile_list ();
+    const size_t w = 97;
+    const size_t h = 61;
+    for (const auto &t : tl)
+    {
+        for (auto scale : { 0.7, 5.0 })
+        {
+            for (auto angle : { 0.0, 17.0 })
+            {
+                const auto locs = get_window_tile_locations (h, w, point (w / 2.0, h / 2.0), scale * t.get_width (), scale * t.get_height (), angle, t.is_triangular (), get_tile_extent (t.get_polygons (), scale, angle));
+                const auto p = get_covering_polygons (w, h, get_tiled_polygon_soup (locs, t.get_polygons (), scale, angle));
+                const polygon_coverage c = get_polygon_coverage (h, w, p);
+                vector<rgb8_pixel_t> m (c.size ());
+                for (size_t i = 0; i < m.size (); ++i)
+                    m[i] = rgb8_pixel_t { static_cast<unsigned char> (i * 37), static_cast<unsigned char> (i * 11), static_cast<unsigned char> (i * 5) };
+                rgb8_image_t a (h, w);
+                fill (a, c, m);
+                coverage_row_painter<rgb8_pixel_t> r (w, c, m);
+                vector<unsigned char> row (w * 3);
+                for (size_t y = 0; y < h; ++y)
+                {
+                    r.paint (row.data ());
+                    VERIFY (equal (row.begin (), row.end (), &a (y, 0, 0)));
+                }
+            }
+        }
+    }
+    // tilings rarely put whole pixels on the edges of earlier polygons, so do it on purpose
+    const rect window (0, 0, 30, 20);
+    polygon_coverage c (4);
+    get_convex_polygon_coverage (polygon { point (2.5, 1.5), point (20.3, 3.2), point (8.1, 15.7) }, window, c[0]);
+    get_convex_polygon_coverage (polygon { point (5, 3), point (15, 3), point (15, 12), point (5, 12) }, window, c[1]);
+    get_convex_polygon_coverage (polygon { point (12.2, 0.4), point (29.5, 10.1), point (3.3, 19.6) }, window, c[2]);
+    get_convex_polygon_coverage (polygon { point (9, 7), point (11, 7), point (11, 9), point (9, 9) }, window, c[3]);
+    const vector<rgb8_pixel_t> m { rgb8_pixel_t { 200, 10, 30 }, rgb8_pixel_t { 20, 220, 40 }, rgb8_pixel_t { 60, 70, 240 }, rgb8_pixel_t { 255, 255, 0 } };
+    rgb8_image_t a (window.height, window.width);
+    fill (a, c, m);
+    coverage_row_painter<rgb8_pixel_t> r (window.width, c, m);
+    vector<unsigned char> row (window.width * 3);
+    for (size_t y = 0; y < window.height; ++y)
+    {
+        r.paint (row.data ());
+        VERIFY (equal (row.begin (), row.end (), &a (y, 0, 0)));
+    }
+    // the last polygon that covers a whole pixel wins
+    VERIFY (a (8, 10, 0) == 255 && a (8, 10, 1) == 255 && a (8, 10, 2) == 0);
+}
+
+int main ()
+{
+    try
+    {
+        test1 ();
+        test2 ();
+        test3 ();
+        test4 ();
+        test5 ();
+
+        return 0;
+    }
+    catch (const exception &e)
+    {
+        cerr << e.what () << endl;
+        return -1;
+    }
+}
@@ -6,6 +6,7 @@
 
 #include "geometry.h"
 #include "verify.h"
+#include <cmath>
 #include <iostream>
 #include <stdexcept>
 
@@ -44,12 +45,42 @@ void test2 ()
     VERIFY (round (p[3].y) == 1.0);
 }
 
+void test3 ()
+{
+    // composed transforms are close to applying each step
+    points p;
+    for (int i = 0; i < 101; ++i)
+        p.push_back (point (i * 0.37 - 20.0, 13.0 - i * 1.1));
+    const points a = affine (p, 3.0, 0.5, 37.0, point (5.0, -7.0));
+    const points b = translate (rotate (scale (p, 3.0, 0.5), 37.0), point (5.0, -7.0));
+    const points c = affine (p, point (5.0, -7.0), -37.0, 2.0, 0.25);
+    const points d = scale (rotate (translate (p, point (5.0, -7.0)), -37.0), 2.0, 0.25);
+    VERIFY (a.size () == p.size ());
+    for (size_t i = 0; i < p.size (); ++i)
+    {
+        VERIFY (fabs (a[i].x - b[i].x) < 1e-12 && fabs (a[i].y - b[i].y) < 1e-12);
+        VERIFY (fabs (c[i].x - d[i].x) < 1e-12 && fabs (c[i].y - d[i].y) < 1e-12);
+    }
+    // the vectorized kernel gives the same bits, in place or not, for any number of points
+    const affine2 m = translation (point (0.1, 0.2)) * rotation (11.0) * scaling (1.7, 2.9);
+    for (size_t n = 0; n < p.size (); ++n)
+    {
+        points e (n);
+        points f (p.begin (), p.begin () + n);
+        transform_scalar (m, p.data (), e.data (), n);
+        transform (m, f.data (), f.data (), n);
+        for (size_t i = 0; i < n; ++i)
+            VERIFY (e[i] == f[i]);
+    }
+}
+
 int main ()
 {
     try
     {
         test1 ();
         test2 ();
+        test3 ();
 
         return 0;
     }
@@ -5,7 +5,10 @@
 /// @date 2014-03-03
 
 #include "graphics.h"
+#include "tiles.h"
 #include "verify.h"
+#include <algorithm>
+#include <cstdlib>
 #include <iostream>
 #include <stdexcept>
 
@@ -80,6 +83,155 @@ void test4 ()
     VERIFY (!intersects (a, rect (x+w, y+h-1, 1, 1)));
 }
 
+// the original rasterizer: intersect every pair of edges
+scanlines get_pairwise_scanlines (const polygon &p)
+{
+    scanlines s;
+    for (size_t i = 0; i < p.size (); ++i)
+    {
+        line l1 (round (p[i]), round (p[(i + 1) % p.size ()]));
+        for (size_t j = i + 1; j < p.size (); ++j)
+        {
+            line l2 (round (p[j]), round (p[(j + 1) % p.size ()]));
+            scanlines t = get_intersecting_scanlines (l1, l2);
+            s.insert (s.end (), t.begin (), t.end ());
+        }
+    }
+    sort (s.begin (), s.end (), [] (const scanline &a, const scanline &b) { return a.y < b.y; });
+    return s;
+}
+
+void test5 ()
+{
+    // the edge walker gives the same scanlines as intersecting edge pairs
+    const tile_list tl = create_tile_list ();
+    size_t pixels = 0;
+    size_t differences = 0;
+    for (size_t i = 0; i < 10000; ++i)
+    {
+        const auto &t = tl[i % tl.size ()];
+        const auto &q = t.get_polygons ()[i % t.get_polygons ().size ()];
+        const double s = 1 + rand () % 50;
+        const polygon p = affine (q, s, s, rand () % 360, point (rand () % 1000 / 7.0, rand () % 1000 / 3.0));
+        const scanlines a = get_pairwise_scanlines (p);
+        const scanlines b = get_convex_polygon_scanlines (p);
+        VERIFY (a.size () == b.size ());
+        for (size_t j = 0; j < a.size (); ++j)
+        {
+            VERIFY (a[j].y == b[j].y);
+            pixels += a[j].len;
+            // the old rasterizer's slopes were slightly imprecise
+            differences += abs (a[j].x - b[j].x) + abs ((a[j].x + int (a[j].len)) - (b[j].x + int (b[j].len)));
+        }
+    }
+    VERIFY (differences * 10000 < pixels);
+}
+
+void test6 ()
+{
+    // scanlines are appended to the caller's buffer
+    polygon p { point (0, 0), point (10, 0), point (10, 10), point (0, 10) };
+    scanlines s { scanline (100, 100, 1) };
+    get_convex_polygon_scanlines (p, s);
+    VERIFY (s.size () == 11);
+    VERIFY (s[0].y == 100);
+    for (int i = 0; i < 10; ++i)
+        VERIFY (s[i + 1].y == i && s[i + 1].x == 0 && s[i + 1].len == 10);
+    // degenerate polygons have no scanlines
+    s.clear ();
+    get_convex_polygon_scanlines (polygon { point (0, 0), point (10, 0.2), point (20, 0.1) }, s);
+    VERIFY (s.empty ());
+}
+
+template<typename I>
+void test_span_filler (I &a, I &b, const unsigned char *m)
+{
+    for (size_t len = 0; len <= 40; ++len)
+    {
+        const scanline s (1, 3, len);
+        const span_filler<I> f (a, m);
+        f.fill (a, s);
+        for (size_t x = s.x; x < s.x + s.len; ++x)
+            for (size_t k = 0; k < b.channels (); ++k)
+                b (s.y, x, k) = m[k];
+        VERIFY (equal (&a[0], &a[0] + a.size (), &b[0]));
+    }
+}
+
+void test7 ()
+{
+    // runs of gray and colored pixels of every length are the same as writing one channel at a time
+    const unsigned char gray[4] = { 7, 7, 7, 7 };
+    const unsigned char color[4] = { 1, 2, 3, 4 };
+    for (auto m : { gray, color })
+    {
+        image<unsigned char,1> a1 (3, 50), b1 (3, 50);
+        test_span_filler (a1, b1, m);
+        rgb8_image_t a3 (3, 50), b3 (3, 50);
+        test_span_filler (a3, b3, m);
+        image<unsigned char,3,std::vector<unsigned char>,bgr_order> c3 (3, 50), d3 (3, 50);
+        test_span_filler (c3, d3, m);
+        image<unsigned char,4> a4 (3, 50), b4 (3, 50);
+        test_span_filler (a4, b4, m);
+    }
+}
+
+void test8 ()
+{
+    // fixed point blends are rounded to the nearest value
+    for (size_t n = 0; n <= 40; ++n)
+    {
+        for (unsigned alpha : { 0u, 1u, 30u, 50u, 99u, 100u })
+        {
+            vector<unsigned char> a (n), b (n), c (n);
+            for (size_t i = 0; i < n; ++i)
+            {
+                a[i] = rand () % 256;
+                b[i] = rand () % 256;
+            }
+            alpha_blend (a.data (), b.data (), c.data (), n, alpha);
+            for (size_t i = 0; i < n; ++i)
+                VERIFY (c[i] == (a[i] * alpha + b[i] * (100 - alpha) + 50) / 100);
+        }
+    }
+}
+
+template<typename I>
+void test_composite_image ()
+{
+    I a (20, 35), b (20, 35);
+    for (size_t i = 0; i < a.size (); ++i)
+    {
+        a[i] = rand () % 256;
+        b[i] = rand () % 256;
+    }
+    const polygon p { point (2, 3), point (30, 5), point (17, 18) };
+    grayscale8_image_t outlines (a.rows (), a.cols ());
+    draw_lines (outlines, p, 255);
+    const rgb8_pixel_t c { 10, 20, 30 };
+    for (unsigned t : { 0u, 40u })
+    {
+        // blending and then outlining gives the same image
+        I expected (b);
+        alpha_blend (a, expected, t);
+        draw_lines (expected, p, c);
+        I img;
+        composite_image (a, b, t, outlines, c, img);
+        VERIFY (img == expected);
+        // without outlines
+        expected = b;
+        alpha_blend (a, expected, t);
+        composite_image (a, b, t, grayscale8_image_t (), c, img);
+        VERIFY (img == expected);
+    }
+}
+
+void test9 ()
+{
+    test_composite_image<rgb8_image_t> ();
+    test_composite_image<image<unsigned char,3,std::vector<unsigned char>,bgr_order>> ();
+}
+
 int main (int argc, char **)
 {
     const bool verbose = (argc != 1);
@@ -89,6 +241,11 @@ int main (int argc, char **)
         test2 (verbose);
         test3 (verbose);
         test4 ();
+        test5 ();
+        test6 ();
+        test7 ();
+        test8 ();
+        test9 ();
 
         return 0;
     }
@@ -11,6 +11,7 @@
 #include <complex>
 #include <iostream>
 #include <list>
+#include <memory>
 #include <numeric>
 #include <stdexcept>
 #include <vector>
@@ -77,6 +78,35 @@ void test2 ()
     VERIFY (*(a.end () - 1) == 32);
 }
 
+void test3 ()
+{
+    // channel order only changes the layout
+    image<int,3,std::vector<int>,bgr_order> a (2, 3);
+    a (1, 2, 0) = 10;
+    a (1, 2, 1) = 11;
+    a (1, 2, 2) = 12;
+    VERIFY (a.index (1, 2, 0) == 17);
+    VERIFY (a[15] == 12);
+    VERIFY (a[16] == 11);
+    VERIFY (a[17] == 10);
+    // an image may refer to memory that it does not own
+    std::shared_ptr<std::vector<int>> v = std::make_shared<std::vector<int>> (2 * 3 * 3, 5);
+    image<int,3,buffer_container<int>> b (2, 3, buffer_container<int> (v->data (), v->size (), v));
+    b (0, 1, 2) = 7;
+    VERIFY ((*v)[5] == 7);
+    // copies are deep
+    image<int,3,buffer_container<int>> c (b);
+    c (0, 1, 2) = 8;
+    VERIFY ((*v)[5] == 7);
+    VERIFY (c != b);
+    c (0, 1, 2) = 7;
+    VERIFY (c == b);
+    // the owner is kept alive
+    v.reset ();
+    VERIFY (b (0, 1, 2) == 7);
+    VERIFY (b (1, 2, 2) == 5);
+}
+
 int main ()
 {
     try
@@ -92,6 +122,7 @@ int main ()
         test1<double,4,19,23> ();
 
         test2<int,3,19,23> ();
+        test3 ();
 
         return 0;
     }
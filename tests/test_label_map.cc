@@ -0,0 +1,122 @@
+/// @file test_label_map.cc
+/// @brief test label map functionality
+/// @author Jeff Perry <jeffsp@gmail.com>
+/// @version 1.0
+/// @date 2014-07-27
+
+#include "graphics.h"
+#include "image.h"
+#include "label_map.h"
+#include "stats.h"
+#include "tiler.h"
+#include "tiles.h"
+#include "verify.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+
+using namespace image_tiler;
+using namespace std;
+
+rgb8_image_t random_image (const size_t rows, const size_t cols)
+{
+    rgb8_image_t img (rows, cols);
+    for (size_t i = 0; i < img.size (); ++i)
+        img[i] = rand () % 256;
+    return img;
+}
+
+void test1 ()
+{
+    // disjoint polygons give the same statistics as their scanlines
+    const rgb8_image_t img = random_image (40, 50);
+    const polygons p {
+        polygon { point (1, 1), point (20, 1), point (20, 30), point (1, 30) },
+        polygon { point (25, 5), point (45, 10), point (30, 35) } };
+    const label_map_t l = get_label_map (img.rows (), img.cols (), p);
+    VERIFY (l (0, 0) == no_label);
+    VERIFY (l (2, 2) == 0);
+    VERIFY (l (15, 33) == 1);
+    const auto a = get_label_stats (img, l, p.size ());
+    const auto b = get_region_stats (img, get_polygon_scanlines (p));
+    VERIFY (a.size () == b.size ());
+    for (size_t i = 0; i < a.size (); ++i)
+    {
+        VERIFY (a[i].count == b[i].count);
+        for (size_t k = 0; k < 3; ++k)
+            VERIFY (a[i].mean[k] == b[i].mean[k]);
+    }
+}
+
+void test2 ()
+{
+    // painting a label map is the same as filling the scanlines in order
+    const size_t w = 301;
+    const size_t h = 203;
+    const tile_list tl = create_tile_list ();
+    for (const auto &t : tl)
+    {
+        const double scale = 7.0;
+        const double angle = 20.0;
+        const auto locs = get_tile_locations (h, w, point (w / 2.0, h / 2.0), scale * t.get_width (), scale * t.get_height (), angle, t.is_triangular ());
+        const auto p = get_intersecting_polygons (w, h, get_tiled_polygons (locs, t.get_polygons (), scale, angle));
+        vector<rgb8_pixel_t> m (p.size ());
+        for (auto &i : m)
+            i = { static_cast<unsigned char> (rand ()), static_cast<unsigned char> (rand ()), static_cast<unsigned char> (rand ()) };
+        rgb8_image_t a (h, w);
+        paint_label_map (get_label_map (h, w, p), m, a);
+        rgb8_image_t b (h, w);
+        fill (b, clip_scanlines (w, h, get_polygon_scanlines (p)), m);
+        VERIFY (equal (a.begin (), a.end (), b.begin ()));
+    }
+}
+
+void test3 ()
+{
+    // painting rows one at a time is the same as filling an image
+    const size_t w = 257;
+    const size_t h = 131;
+    const tile_list tl = create_tile_list ();
+    for (const auto &t : tl)
+    {
+        const double scale = 6.0;
+        const double angle = 35.0;
+        const auto locs = get_tile_locations (h, w, point (w / 2.0, h / 2.0), scale * t.get_width (), scale * t.get_height (), angle, t.is_triangular ());
+        const auto p = get_intersecting_polygons (w, h, get_tiled_polygons (locs, t.get_polygons (), scale, angle));
+        vector<rgb8_pixel_t> m (p.size ());
+        for (auto &i : m)
+            i = { static_cast<unsigned char> (rand ()), static_cast<unsigned char> (rand ()), static_cast<unsigned char> (rand ()) };
+        const polygon_scanlines s = clip_scanlines (w, h, get_polygon_scanlines (p));
+        rgb8_image_t a (h, w);
+        fill (a, s, m);
+        const label_map_t l = get_label_map (h, w, p);
+        scanline_row_painter<rgb8_pixel_t> painter (w, s, m);
+        vector<unsigned char> b (w * 3, 1);
+        vector<unsigned char> c (w * 3, 1);
+        for (size_t y = 0; y < h; ++y)
+        {
+            painter.paint (&b[0]);
+            paint_label_map_row (l, m, y, &c[0]);
+            VERIFY (equal (b.begin (), b.end (), &a (y, 0, 0)));
+            VERIFY (equal (c.begin (), c.end (), &a (y, 0, 0)));
+        }
+    }
+}
+
+int main ()
+{
+    try
+    {
+        test1 ();
+        test2 ();
+        test3 ();
+
+        return 0;
+    }
+    catch (const exception &e)
+    {
+        cerr << e.what () << endl;
+        return -1;
+    }
+}
@@ -0,0 +1,107 @@
+/// @file test_mmap_image.cc
+/// @brief test memory mapped images
+/// @author Jeff Perry <jeffsp@gmail.com>
+/// @version 1.0
+/// @date 2014-07-27
+
+#include "graphics.h"
+#include "image.h"
+#include "mmap_image.h"
+#include "ppm.h"
+#include "stats.h"
+#include "verify.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+using namespace image_tiler;
+using namespace std;
+
+const size_t rows = 19;
+const size_t cols = 23;
+
+rgb8_image_t random_image ()
+{
+    rgb8_image_t img (rows, cols);
+    for (size_t i = 0; i < img.size (); ++i)
+        img[i] = rand () % 256;
+    return img;
+}
+
+void write_file (const string &fn, const string &header, const rgb8_image_t &img)
+{
+    ofstream ofs (fn.c_str (), ios::binary);
+    ofs << header;
+    ofs.write (reinterpret_cast<const char *> (&img[0]), img.size ());
+}
+
+void test1 ()
+{
+    const rgb8_image_t img = random_image ();
+    const string fn = "test_mmap_image_tmp.ppm";
+    write_file (fn, "P6\n23 19\n255\n", img);
+    {
+        mmap_rgb8_image_t m = map_ppm_image (fn);
+        VERIFY (m.rows () == rows);
+        VERIFY (m.cols () == cols);
+        VERIFY (equal (img.begin (), img.end (), m.begin ()));
+        // statistics are the same as for a vector backed image
+        const scanlines s { scanline (1, 2, 10), scanline (2, 0, 23) };
+        const auto a = get_region_stats (img, s, stats_all);
+        const auto b = get_region_stats (m, s, stats_all);
+        for (size_t k = 0; k < 3; ++k)
+        {
+            VERIFY (a.mean[k] == b.mean[k]);
+            VERIFY (a.median[k] == b.median[k]);
+        }
+        // copies are deep
+        mmap_rgb8_image_t c (m);
+        c (0, 0, 0) = img (0, 0, 0) + 1;
+        VERIFY (m (0, 0, 0) == img (0, 0, 0));
+        // writes do not change the file
+        m (0, 0, 0) = img (0, 0, 0) + 1;
+        VERIFY (m (0, 0, 0) != img (0, 0, 0));
+    }
+    const mmap_rgb8_image_t m = map_ppm_image (fn);
+    VERIFY (m (0, 0, 0) == img (0, 0, 0));
+    remove (fn.c_str ());
+}
+
+void test2 ()
+{
+    const rgb8_image_t img = random_image ();
+    const string fn = "test_mmap_image_tmp.pam";
+    write_file (fn, "P7\nWIDTH 23\nHEIGHT 19\nDEPTH 3\nMAXVAL 255\nTUPLTYPE RGB\nENDHDR\n", img);
+    const mmap_rgb8_image_t m = map_ppm_image (fn);
+    VERIFY (equal (img.begin (), img.end (), m.begin ()));
+    remove (fn.c_str ());
+    // raw
+    const string raw = "test_mmap_image_tmp.rgb";
+    write_file (raw, "", img);
+    const mmap_rgb8_image_t r = map_rgb_image (raw, rows, cols);
+    VERIFY (equal (img.begin (), img.end (), r.begin ()));
+    bool failed = false;
+    try { map_rgb_image (raw, rows + 1, cols); }
+    catch (...) { failed = true; }
+    VERIFY (failed);
+    remove (raw.c_str ());
+}
+
+int main ()
+{
+    try
+    {
+        test1 ();
+        test2 ();
+
+        return 0;
+    }
+    catch (const exception &e)
+    {
+        cerr << e.what () << endl;
+        return -1;
+    }
+}
@@ -0,0 +1,159 @@
+/// @file test_pipeline.cc
+/// @brief test pipelined batch processing
+/// @author Jeff Perry <jeffsp@gmail.com>
+/// @version 1.0
+/// @date 2014-07-27
+
+#include "batch.h"
+#include "pipeline.h"
+#include "verify.h"
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace image_tiler;
+using namespace std;
+
+void test1 ()
+{
+    // jobs go through every stage, in order
+    const size_t n = 1000;
+    vector<size_t> done;
+    atomic<size_t> in_flight (0);
+    size_t max_in_flight = 0;
+    run_pipeline (n,
+        [&] (size_t i) { ++in_flight; return vector<size_t> (1, i); },
+        [&] (vector<size_t> &s) { max_in_flight = max (max_in_flight, in_flight.load ()); s.push_back (s[0] * 2); },
+        [&] (vector<size_t> &s) { done.push_back (s[1]); --in_flight; },
+        2);
+    VERIFY (done.size () == n);
+    for (size_t i = 0; i < n; ++i)
+        VERIFY (done[i] == i * 2);
+    // memory use is bounded
+    VERIFY (max_in_flight <= 2 * 2 + 3);
+    // no jobs
+    run_pipeline (0, [] (size_t i) { return i; }, [] (size_t &) { }, [] (size_t &) { VERIFY (false); });
+}
+
+void test2 ()
+{
+    // a failure in any stage stops the pipeline and is rethrown
+    for (size_t stage = 0; stage < 3; ++stage)
+    {
+        bool thrown = false;
+        try
+        {
+            run_pipeline (100000,
+                [&] (size_t i) { if (stage == 0 && i == 10) throw runtime_error ("first"); return i; },
+                [&] (size_t &i) { if (stage == 1 && i == 10) throw runtime_error ("second"); },
+                [&] (size_t &i) { if (stage == 2 && i == 10) throw runtime_error ("third"); });
+        }
+        catch (const runtime_error &)
+        {
+            thrown = true;
+        }
+        VERIFY (thrown);
+    }
+}
+
+void test3 ()
+{
+    // bounded queues
+    bounded_queue<int> q (3);
+    VERIFY (q.push (1));
+    VERIFY (q.push (2));
+    int x = 0;
+    VERIFY (q.pop (x) && x == 1);
+    q.close ();
+    VERIFY (!q.push (3));
+    VERIFY (q.pop (x) && x == 2);
+    VERIFY (!q.pop (x));
+}
+
+void test4 ()
+{
+    // manifests
+    VERIFY (get_stem ("a/b.c/d.png") == "d");
+    VERIFY (get_stem ("a/b.c/d") == "d");
+    VERIFY (get_stem (".hidden") == ".hidden");
+    VERIFY (get_output_filename ("in/x.png", "out", "jpg") == "out/x.jpg");
+    VERIFY (get_output_filename ("x.png", "out/", "svg") == "out/x.svg");
+    VERIFY (is_image_filename ("x.JPG"));
+    VERIFY (!is_image_filename ("x.txt"));
+    stringstream s;
+    s << "# comment" << endl;
+    s << "in/a.png" << endl;
+    s << endl;
+    s << "  in/b.ppm   elsewhere/b.jpg  " << endl;
+    const batch_jobs j = read_manifest (s, "out", "jpg");
+    VERIFY (j.size () == 2);
+    VERIFY (j[0].input == "in/a.png");
+    VERIFY (j[0].output == "out/a.jpg");
+    VERIFY (j[1].input == "in/b.ppm");
+    VERIFY (j[1].output == "elsewhere/b.jpg");
+}
+
+void test5 ()
+{
+    // inputs that only differ by their extension would overwrite each other
+    stringstream s;
+    s << "in/a.png" << endl;
+    s << "in/b.png" << endl;
+    s << "in/a.jpg" << endl;
+    const batch_jobs j = read_manifest (s, "out", "jpg");
+    bool thrown = false;
+    try { check_outputs (j); }
+    catch (const runtime_error &) { thrown = true; }
+    VERIFY (thrown);
+    check_outputs (batch_jobs (j.begin (), j.begin () + 2));
+    // missing output directories are created, along with their parents
+    create_directory ("test_pipeline_tmp/a/b");
+    VERIFY (is_directory ("test_pipeline_tmp/a/b"));
+    create_directory ("test_pipeline_tmp/a/b/");
+    VERIFY (remove ("test_pipeline_tmp/a/b") == 0);
+    VERIFY (remove ("test_pipeline_tmp/a") == 0);
+    VERIFY (remove ("test_pipeline_tmp") == 0);
+}
+
+void test6 ()
+{
+    // the directories of outputs named in a manifest are created before any work is done
+    {
+        ofstream ofs ("test_pipeline_manifest.txt");
+        ofs << "in/a.png test_pipeline_tmp/x/a.jpg" << endl;
+        ofs << "in/b.png" << endl;
+    }
+    const batch_jobs j = get_batch_jobs ("test_pipeline_manifest.txt", "test_pipeline_tmp/out", "jpg");
+    VERIFY (j.size () == 2);
+    VERIFY (is_directory ("test_pipeline_tmp/x"));
+    VERIFY (is_directory ("test_pipeline_tmp/out"));
+    VERIFY (remove ("test_pipeline_tmp/x") == 0);
+    VERIFY (remove ("test_pipeline_tmp/out") == 0);
+    VERIFY (remove ("test_pipeline_tmp") == 0);
+    VERIFY (remove ("test_pipeline_manifest.txt") == 0);
+}
+
+int main ()
+{
+    try
+    {
+        test1 ();
+        test2 ();
+        test3 ();
+        test4 ();
+        test5 ();
+        test6 ();
+
+        return 0;
+    }
+    catch (const exception &e)
+    {
+        cerr << e.what () << endl;
+        return -1;
+    }
+}
@@ -0,0 +1,122 @@
+/// @file test_polygon_soup.cc
+/// @brief test polygon soups
+/// @author Jeff Perry <jeffsp@gmail.com>
+/// @version 1.0
+/// @date 2014-07-27
+
+#include "image_elements.h"
+#include "label_map.h"
+#include "polygon_soup.h"
+#include "tiler.h"
+#include "tiles.h"
+#include "verify.h"
+#include <iostream>
+#include <stdexcept>
+
+using namespace image_tiler;
+using namespace std;
+
+template<typename P,typename Q>
+bool same (const P &a, const Q &b)
+{
+    if (a.size () != b.size ()
+        || a.get_tile_index () != b.get_tile_index ()
+        || a.get_polygon_index () != b.get_polygon_index ())
+        return false;
+    for (size_t i = 0; i < a.size (); ++i)
+        if (!(a[i] == b[i]))
+            return false;
+    return true;
+}
+
+void test1 ()
+{
+    // copying
+    polygon_soup s;
+    VERIFY (s.empty ());
+    VERIFY (s.size () == 0);
+    VERIFY (s.begin () == s.end ());
+    polygon a { point (1, 2), point (5, -3), point (4, 7) };
+    a.set_tile_index (3);
+    a.set_polygon_index (1);
+    polygon b;
+    b.set_tile_index (4);
+    b.set_polygon_index (0);
+    const polygons p { a, b, a };
+    s = polygon_soup (p);
+    VERIFY (s.size () == 3);
+    VERIFY (s.vertex_count () == 6);
+    VERIFY (s.get_offsets ().size () == 4);
+    VERIFY (same (s[0], a));
+    VERIFY (same (s[1], b));
+    VERIFY (s[1].empty ());
+    VERIFY (same (s[2], a));
+    VERIFY (s[2].back () == point (4, 7));
+    const rectf &r = s[0].get_bounds ();
+    VERIFY (r.minx == 1 && r.miny == -3 && r.maxx == 5 && r.maxy == 7);
+    const polygons q = to_polygons (s);
+    VERIFY (q.size () == 3);
+    for (size_t i = 0; i < q.size (); ++i)
+        VERIFY (same (q[i], p[i]));
+    size_t n = 0;
+    for (const auto &i : s)
+        VERIFY (same (i, p[n++]));
+    VERIFY (n == 3);
+    s.clear ();
+    VERIFY (s.empty ());
+    VERIFY (s.vertex_count () == 0);
+}
+
+void test2 ()
+{
+    // the soup stages give the same results as the polygons stages
+    const tile_list tl = create_tile_list ();
+    for (const auto &t : tl)
+    {
+        for (auto scale : { 3.5, 21.0 })
+        {
+            for (auto angle : { 0.0, 17.0, 250.0 })
+            {
+                const size_t w = 203;
+                const size_t h = 161;
+                const auto locs = get_window_tile_locations (h, w, point (w / 2.0, h / 2.0), scale * t.get_width (), scale * t.get_height (), angle, t.is_triangular (), get_tile_extent (t.get_polygons (), scale, angle));
+                const polygons a = get_tiled_polygons (locs, t.get_polygons (), scale, angle);
+                const polygon_soup b = get_tiled_polygon_soup (locs, t.get_polygons (), scale, angle);
+                VERIFY (a.size () == b.size ());
+                for (size_t i = 0; i < a.size (); ++i)
+                {
+                    VERIFY (same (b[i], a[i]));
+                    const rectf r = get_bounding_rectf (a[i]);
+                    const rectf &s = b[i].get_bounds ();
+                    VERIFY (r.minx == s.minx && r.miny == s.miny && r.maxx == s.maxx && r.maxy == s.maxy);
+                }
+                const polygons pa = get_intersecting_polygons (w, h, a);
+                const polygon_soup pb = get_intersecting_polygons (w, h, b);
+                VERIFY (pa.size () == pb.size ());
+                for (size_t i = 0; i < pa.size (); ++i)
+                    VERIFY (same (pb[i], pa[i]));
+                VERIFY (get_polygon_scanlines (pa) == get_polygon_scanlines (pb));
+                const polygons prototypes = get_prototype_polygons (t.get_polygons (), scale, angle);
+                for (auto mode : { raster_cache_mode::exact, raster_cache_mode::quantized })
+                    VERIFY (get_polygon_scanlines (pa, prototypes, mode) == get_polygon_scanlines (pb, prototypes, mode));
+                VERIFY (get_label_map (h, w, pa) == get_label_map (h, w, pb));
+            }
+        }
+    }
+}
+
+int main ()
+{
+    try
+    {
+        test1 ();
+        test2 ();
+
+        return 0;
+    }
+    catch (const exception &e)
+    {
+        cerr << e.what () << endl;
+        return -1;
+    }
+}
@@ -0,0 +1,88 @@
+/// @file test_ppm.cc
+/// @brief test PPM/PAM functionality
+/// @author Jeff Perry <jeffsp@gmail.com>
+/// @version 1.0
+/// @date 2014-07-27
+
+#include "image.h"
+#include "ppm.h"
+#include "verify.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+using namespace image_tiler;
+using namespace std;
+
+void test1 ()
+{
+    stringstream s ("P6\n# a comment\n17 # another\n 5\n255\nxyz");
+    const ppm_header h = read_ppm_header (s);
+    VERIFY (h.cols == 17);
+    VERIFY (h.rows == 5);
+    VERIFY (h.channels == 3);
+    VERIFY (h.offset == 35);
+    VERIFY (s.get () == 'x');
+    stringstream t ("P7\nWIDTH 4\nHEIGHT 3\nDEPTH 3\nMAXVAL 255\nTUPLTYPE RGB\nENDHDR\nxyz");
+    const ppm_header g = read_ppm_header (t);
+    VERIFY (g.cols == 4);
+    VERIFY (g.rows == 3);
+    VERIFY (t.get () == 'x');
+    stringstream u ("P5\n4 3\n255\n");
+    bool failed = false;
+    try { read_ppm_header (u); }
+    catch (...) { failed = true; }
+    VERIFY (failed);
+    VERIFY (is_ppm_filename ("a.ppm"));
+    VERIFY (is_ppm_filename ("a.b.PAM"));
+    VERIFY (!is_ppm_filename ("ppm"));
+    VERIFY (!is_ppm_filename ("a.jpg"));
+}
+
+void test2 ()
+{
+    // write and read back a band at a time
+    const string fn = "test_ppm_tmp.ppm";
+    const size_t rows = 11;
+    const size_t cols = 13;
+    rgb8_image_t band (4, cols);
+    {
+        ppm_band_writer w (fn, rows, cols);
+        for (size_t r = 0; r < rows; r += 4)
+        {
+            for (size_t i = 0; i < band.size (); ++i)
+                band[i] = r * cols * 3 + i;
+            w.write (band, min<size_t> (4, rows - r));
+        }
+    }
+    ppm_band_reader r (fn);
+    VERIFY (r.rows () == rows);
+    VERIFY (r.cols () == cols);
+    for (size_t y = 0; y < rows; y += 4)
+    {
+        r.read (band, min<size_t> (4, rows - y));
+        for (size_t i = 0; i < min<size_t> (4, rows - y) * cols * 3; ++i)
+            VERIFY (band[i] == static_cast<unsigned char> (y * cols * 3 + i));
+    }
+    remove (fn.c_str ());
+}
+
+int main ()
+{
+    try
+    {
+        test1 ();
+        test2 ();
+
+        return 0;
+    }
+    catch (const exception &e)
+    {
+        cerr << e.what () << endl;
+        return -1;
+    }
+}
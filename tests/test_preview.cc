@@ -0,0 +1,153 @@
+/// @file test_preview.cc
+/// @brief test incrementally updated previews
+/// @author Jeff Perry <jeffsp@gmail.com>
+/// @version 1.0
+/// @date 2014-07-27
+
+#include "preview.h"
+#include "verify.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+
+using namespace image_tiler;
+using namespace std;
+
+rgb8_image_t random_image (const size_t rows, const size_t cols)
+{
+    rgb8_image_t img (rows, cols);
+    for (size_t i = 0; i < img.size (); ++i)
+        img[i] = rand () % 256;
+    return img;
+}
+
+// compute everything from scratch
+rgb8_image_t get_expected (const rgb8_image_t &original, const tile_list &tl, const preview_params &p)
+{
+    const size_t w = original.cols ();
+    const size_t h = original.rows ();
+    const convex_uniform_tile &t = tl[p.tile_index];
+    const auto locs = get_tile_locations (h, w, point (p.xoffset + w / 2.0, p.yoffset + h / 2.0), p.scale * t.get_width (), p.scale * t.get_height (), p.angle, t.is_triangular ());
+    const auto all_polys = get_tiled_polygons (locs, t.get_polygons (), p.scale, p.angle);
+    const image_elements e = get_image_elements (original, get_intersecting_polygons (w, h, all_polys));
+    rgb8_image_t img (original);
+    fill (img, e.s, e.m);
+    for (size_t i = 0; i < img.size (); ++i)
+        img[i] = (original[i] * p.transparency + img[i] * (100 - p.transparency) + 50) / 100;
+    if (p.outline)
+        for (const auto &i : all_polys)
+            draw_lines (img, i, {212, 212, 212});
+    return img;
+}
+
+void test1 ()
+{
+    // every change gives the same image as starting over
+    const rgb8_image_t original = random_image (97, 131);
+    const tile_list tl = create_tile_list ();
+    preview<rgb8_image_t> pv (original, tl);
+    preview_params p;
+    p.scale = 5.0;
+    for (size_t i = 0; i < 8; ++i)
+    {
+        switch (i)
+        {
+            case 1: p.transparency = 30; break;
+            case 2: p.outline = true; break;
+            case 3: p.angle = 17.0; break;
+            case 4: p.tile_index = 3; break;
+            case 5: p.transparency = 0; break;
+            case 6: p.xoffset = 4.0; break;
+            case 7: p.scale = 7.0; break;
+        }
+        pv.set_params (p);
+        VERIFY (pv.get_image () == get_expected (original, tl, p));
+    }
+}
+
+void test2 ()
+{
+    // compositing changes leave the colors alone
+    const rgb8_image_t original = random_image (50, 60);
+    const tile_list tl = create_tile_list ();
+    preview<rgb8_image_t> pv (original, tl);
+    preview_params p;
+    p.scale = 4.0;
+    p.randomize = true;
+    pv.set_params (p);
+    const auto m = pv.get_elements ().m;
+    p.transparency = 50;
+    p.outline = true;
+    pv.set_params (p);
+    pv.get_image ();
+    VERIFY (pv.get_elements ().m == m);
+    // other changes recompute them
+    p.randomize = false;
+    pv.set_params (p);
+    VERIFY (pv.get_elements ().m == get_image_elements (original, pv.get_elements ().p).m);
+}
+
+void test3 ()
+{
+    // pyramid means only recompute the means
+    const rgb8_image_t original = random_image (200, 300);
+    const tile_list tl = create_tile_list ();
+    preview<rgb8_image_t> pv (original, tl);
+    preview_params p;
+    p.scale = 20.0;
+    pv.set_params (p);
+    const image_elements e = pv.get_elements ();
+    p.min_pixels = 16;
+    pv.set_params (p);
+    const image_pyramid<rgb8_image_t> pyr (original);
+    VERIFY (pv.get_elements ().m == get_colors (get_region_stats (pyr, e.s, p.min_pixels)));
+    VERIFY (pv.get_elements ().m != e.m);
+    p.min_pixels = 0;
+    pv.set_params (p);
+    VERIFY (pv.get_elements ().m == e.m);
+}
+
+void test4 ()
+{
+    // compositing into a caller's image gives the same image as the cached composite
+    const rgb8_image_t original = random_image (80, 90);
+    const tile_list tl = create_tile_list ();
+    preview<rgb8_image_t> pv (original, tl);
+    preview_params p;
+    p.scale = 6.0;
+    rgb8_image_t img;
+    for (size_t i = 0; i < 4; ++i)
+    {
+        p.transparency = i * 33;
+        p.outline = (i & 1) != 0;
+        pv.set_params (p);
+        VERIFY (pv.render ([] () { return false; }, img));
+        VERIFY (img == get_expected (original, tl, p));
+        VERIFY (img == pv.get_image ());
+    }
+    // cancelled work leaves the image alone
+    p.angle = 10.0;
+    pv.set_params (p);
+    const rgb8_image_t last (img);
+    VERIFY (!pv.render ([] () { return true; }, img));
+    VERIFY (img == last);
+}
+
+int main ()
+{
+    try
+    {
+        test1 ();
+        test2 ();
+        test3 ();
+        test4 ();
+
+        return 0;
+    }
+    catch (const exception &e)
+    {
+        cerr << e.what () << endl;
+        return -1;
+    }
+}
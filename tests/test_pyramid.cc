@@ -0,0 +1,132 @@
+/// @file test_pyramid.cc
+/// @brief test pyramid statistics
+/// @author Jeff Perry <jeffsp@gmail.com>
+/// @version 1.0
+/// @date 2014-07-27
+
+#include "image_elements.h"
+#include "pyramid.h"
+#include "tiles.h"
+#include "verify.h"
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+
+using namespace image_tiler;
+using namespace std;
+
+// a smooth image
+template<typename I>
+I ramp_image (const size_t rows, const size_t cols)
+{
+    I img (rows, cols);
+    for (size_t r = 0; r < rows; ++r)
+        for (size_t c = 0; c < cols; ++c)
+            for (size_t k = 0; k < img.channels (); ++k)
+                img (r, c, k) = r * 80 / rows + c * 80 / cols + 40 * k;
+    return img;
+}
+
+void test1 ()
+{
+    // levels
+    const rgb8_image_t img = ramp_image<rgb8_image_t> (101, 37);
+    const image_pyramid<rgb8_image_t> pyr (img);
+    VERIFY (&pyr[0] == &img);
+    VERIFY (pyr.size () == 7);
+    VERIFY (pyr[1].rows () == 51);
+    VERIFY (pyr[1].cols () == 19);
+    VERIFY (pyr[2].rows () == 26);
+    VERIFY (pyr[2].cols () == 10);
+    VERIFY (pyr[6].rows () == 2);
+    VERIFY (pyr[6].cols () == 1);
+    VERIFY (image_pyramid<rgb8_image_t> (img, 3).size () == 3);
+    VERIFY (image_pyramid<rgb8_image_t> (rgb8_image_t (1, 1)).size () == 1);
+    // level selection
+    VERIFY (pyr.get_level (100, 100) == 0);
+    VERIFY (pyr.get_level (399, 100) == 0);
+    VERIFY (pyr.get_level (400, 100) == 1);
+    VERIFY (pyr.get_level (1600, 100) == 2);
+    VERIFY (pyr.get_level (1000000000, 1) == 6);
+}
+
+template<typename I>
+void test2 ()
+{
+    // means are within the documented bound, and small regions are exact
+    const size_t w = 640;
+    const size_t h = 480;
+    const I img = ramp_image<I> (h, w);
+    const image_pyramid<I> pyr (img);
+    const tile_list tl = create_tile_list ();
+    for (auto i : { 0, 10 })
+    {
+        const auto &t = tl[i];
+        for (auto scale : { 4.0, 40.0 })
+        {
+            const double angle = 23.0;
+            const auto locs = get_tile_locations (h, w, point (w / 2.0, h / 2.0), scale * t.get_width (), scale * t.get_height (), angle, t.is_triangular ());
+            const auto p = get_intersecting_polygons (w, h, get_tiled_polygons (locs, t.get_polygons (), scale, angle));
+            const auto s = clip_scanlines (w, h, get_polygon_scanlines (p));
+            const size_t min_pixels = 64;
+            const auto a = get_region_stats (img, s);
+            const auto b = get_region_stats (pyr, s, min_pixels);
+            VERIFY (a.size () == b.size ());
+            size_t coarse = 0;
+            for (size_t j = 0; j < a.size (); ++j)
+            {
+                VERIFY (a[j].count == b[j].count);
+                const size_t l = pyr.get_level (a[j].count, min_pixels);
+                if (l == 0)
+                {
+                    VERIFY (a[j].mean == b[j].mean);
+                    continue;
+                }
+                ++coarse;
+                // the ramp is smooth, so the straddling blocks are close to the mean
+                for (size_t k = 0; k < 3; ++k)
+                    VERIFY (abs (static_cast<int> (a[j].mean[k]) - static_cast<int> (b[j].mean[k])) <= 8);
+            }
+            VERIFY ((scale > 10.0) == (coarse != 0));
+        }
+    }
+}
+
+void test3 ()
+{
+    // a constant image has exact means on every level
+    const rgb8_image_t img (300, 200, 77);
+    const image_pyramid<rgb8_image_t> pyr (img);
+    const scanlines s { scanline (10, 5, 150), scanline (11, 5, 150), scanline (12, 3, 190), scanline (50, 100, 100) };
+    for (size_t min_pixels : { 1, 4, 16, 1000 })
+    {
+        const auto r = get_region_stats (pyr, s, min_pixels);
+        VERIFY (r.count == 590);
+        for (size_t k = 0; k < 3; ++k)
+            VERIFY (r.mean[k] == 77);
+    }
+    // regions that miss every block center fall back to level 0
+    const rgb8_image_t img2 = ramp_image<rgb8_image_t> (300, 200);
+    const image_pyramid<rgb8_image_t> pyr2 (img2);
+    const scanlines s2 { scanline (1, 0, 200) };
+    VERIFY (get_region_stats (pyr2, s2, 1).mean == get_region_stats (img2, s2).mean);
+}
+
+int main ()
+{
+    try
+    {
+        test1 ();
+        test2<rgb8_image_t> ();
+        test2<image<unsigned char,3,buffer_container<unsigned char>,bgr_order>> ();
+        test3 ();
+
+        return 0;
+    }
+    catch (const exception &e)
+    {
+        cerr << e.what () << endl;
+        return -1;
+    }
+}
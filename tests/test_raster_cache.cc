@@ -0,0 +1,92 @@
+/// @file test_raster_cache.cc
+/// @brief test cached rasterization
+/// @author Jeff Perry <jeffsp@gmail.com>
+/// @version 1.0
+/// @date 2014-07-27
+
+#include "raster_cache.h"
+#include "tiles.h"
+#include "verify.h"
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+
+using namespace image_tiler;
+using namespace std;
+
+size_t area (const scanlines &s)
+{
+    size_t n = 0;
+    for (const auto &i : s)
+        n += i.len;
+    return n;
+}
+
+void test1 ()
+{
+    // exact mode is identical to rasterizing every polygon
+    const size_t w = 401;
+    const size_t h = 303;
+    const tile_list tl = create_tile_list ();
+    for (const auto &t : tl)
+    {
+        for (auto scale : { 3.3, 11.0 })
+        {
+            const double angle = 17.0;
+            const auto locs = get_tile_locations (h, w, point (w / 2.0, h / 2.0), scale * t.get_width (), scale * t.get_height (), angle, t.is_triangular ());
+            const auto p = get_intersecting_polygons (w, h, get_tiled_polygons (locs, t.get_polygons (), scale, angle));
+            const auto prototypes = get_prototype_polygons (t.get_polygons (), scale, angle);
+            const auto a = get_polygon_scanlines (p);
+            const auto b = get_polygon_scanlines (p, prototypes, raster_cache_mode::exact);
+            VERIFY (a == b);
+            const auto c = get_polygon_scanlines (p, prototypes, raster_cache_mode::none);
+            VERIFY (a == c);
+            // quantized mode is close
+            const auto d = get_polygon_scanlines (p, prototypes, raster_cache_mode::quantized);
+            VERIFY (a.size () == d.size ());
+            double ea = 0.0;
+            double ed = 0.0;
+            for (size_t i = 0; i < a.size (); ++i)
+            {
+                ea += area (a[i]);
+                ed += fabs (static_cast<double> (area (a[i])) - area (d[i]));
+            }
+            VERIFY (ed < ea * 0.05);
+        }
+    }
+}
+
+void test2 ()
+{
+    // prototypes are the polygons at the origin
+    const tile_list tl = create_tile_list ();
+    const auto &t = tl[10];
+    const auto prototypes = get_prototype_polygons (t.get_polygons (), 5.0, 30.0);
+    const auto p = get_tiled_polygons (points (1, point (7.25, -3.0)), t.get_polygons (), 5.0, 30.0);
+    VERIFY (p.size () == prototypes.size ());
+    for (size_t i = 0; i < p.size (); ++i)
+    {
+        VERIFY (p[i].get_polygon_index () == i);
+        for (size_t j = 0; j < p[i].size (); ++j)
+        {
+            VERIFY (fabs (p[i][j].x - prototypes[i][j].x - 7.25) < 1e-9);
+            VERIFY (fabs (p[i][j].y - prototypes[i][j].y + 3.0) < 1e-9);
+        }
+    }
+}
+
+int main ()
+{
+    try
+    {
+        test1 ();
+        test2 ();
+
+        return 0;
+    }
+    catch (const exception &e)
+    {
+        cerr << e.what () << endl;
+        return -1;
+    }
+}
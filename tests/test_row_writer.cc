@@ -0,0 +1,162 @@
+/// @file test_row_writer.cc
+/// @brief test row at a time encoders
+/// @author Jeff Perry <jeffsp@gmail.com>
+/// @version 1.0
+/// @date 2014-07-27
+
+#include "row_writer.h"
+#include "verify.h"
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+
+using namespace image_tiler;
+using namespace std;
+
+rgb8_image_t get_image (const size_t rows, const size_t cols)
+{
+    rgb8_image_t img (rows, cols);
+    for (size_t r = 0; r < rows; ++r)
+        for (size_t c = 0; c < cols; ++c)
+            for (size_t k = 0; k < 3; ++k)
+                img (r, c, k) = (r + c + k * 60) % 256;
+    return img;
+}
+
+rgb8_image_t read_png (const string &fn)
+{
+    FILE *fp = fopen (fn.c_str (), "rb");
+    VERIFY (fp);
+    png_structp png = png_create_read_struct (PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+    png_infop info = png_create_info_struct (png);
+    png_init_io (png, fp);
+    png_read_info (png, info);
+    VERIFY (png_get_color_type (png, info) == PNG_COLOR_TYPE_RGB);
+    VERIFY (png_get_bit_depth (png, info) == 8);
+    rgb8_image_t img (png_get_image_height (png, info), png_get_image_width (png, info));
+    for (size_t r = 0; r < img.rows (); ++r)
+        png_read_row (png, &img (r, 0, 0), nullptr);
+    png_destroy_read_struct (&png, &info, nullptr);
+    fclose (fp);
+    return img;
+}
+
+rgb8_image_t read_jpeg (const string &fn)
+{
+    FILE *fp = fopen (fn.c_str (), "rb");
+    VERIFY (fp);
+    jpeg_decompress_struct c;
+    jpeg_error_mgr err;
+    c.err = jpeg_std_error (&err);
+    jpeg_create_decompress (&c);
+    jpeg_stdio_src (&c, fp);
+    jpeg_read_header (&c, TRUE);
+    c.out_color_space = JCS_RGB;
+    jpeg_start_decompress (&c);
+    rgb8_image_t img (c.output_height, c.output_width);
+    for (size_t r = 0; r < img.rows (); ++r)
+    {
+        JSAMPROW p = &img (r, 0, 0);
+        jpeg_read_scanlines (&c, &p, 1);
+    }
+    jpeg_finish_decompress (&c);
+    jpeg_destroy_decompress (&c);
+    fclose (fp);
+    return img;
+}
+
+void test1 ()
+{
+    // lossless files are the same as the rows that were written
+    const rgb8_image_t img = get_image (37, 53);
+    for (auto fn : { "test_row_writer_tmp.png", "test_row_writer_tmp.ppm" })
+    {
+        size_t r = 0;
+        write_rows (fn, img.rows (), img.cols (), [&] (unsigned char *dst)
+        {
+            std::copy (&img (r, 0, 0), &img (r, 0, 0) + img.cols () * 3, dst);
+            ++r;
+        });
+        VERIFY (r == img.rows ());
+        if (get_extension (fn) == "png")
+            VERIFY (read_png (fn) == img);
+        else
+        {
+            ppm_band_reader src (fn);
+            rgb8_image_t p (src.rows (), src.cols ());
+            src.read (p, p.rows ());
+            VERIFY (p == img);
+        }
+        remove (fn);
+    }
+    // bands
+    const string fn = "test_row_writer_tmp.png";
+    {
+        png_row_writer w (fn, img.rows (), img.cols ());
+        rgb8_image_t band (10, img.cols ());
+        for (size_t r = 0; r < img.rows (); r += band.rows ())
+        {
+            const size_t n = min (band.rows (), img.rows () - r);
+            std::copy (&img (r, 0, 0), &img (r, 0, 0) + n * img.cols () * 3, &band[0]);
+            w.write (band, n);
+        }
+    }
+    VERIFY (read_png (fn) == img);
+    remove (fn.c_str ());
+}
+
+void test2 ()
+{
+    // lossy files are close to the rows that were written
+    const rgb8_image_t img = get_image (64, 48);
+    const string fn = "test_row_writer_tmp.jpg";
+    size_t r = 0;
+    write_rows (fn, img.rows (), img.cols (), [&] (unsigned char *dst)
+    {
+        std::copy (&img (r, 0, 0), &img (r, 0, 0) + img.cols () * 3, dst);
+        ++r;
+    });
+    const rgb8_image_t j = read_jpeg (fn);
+    VERIFY (j.rows () == img.rows ());
+    VERIFY (j.cols () == img.cols ());
+    double sum = 0;
+    for (size_t i = 0; i < img.size (); ++i)
+        sum += abs (static_cast<int> (img[i]) - static_cast<int> (j[i]));
+    VERIFY (sum / img.size () < 2.0);
+    remove (fn.c_str ());
+    // errors are reported
+    bool thrown = false;
+    try { jpeg_row_writer w ("no_such_directory/x.jpg", 10, 10); }
+    catch (const runtime_error &) { thrown = true; }
+    VERIFY (thrown);
+    thrown = false;
+    try { jpeg_row_writer w (fn, 0, 10); }
+    catch (const runtime_error &) { thrown = true; }
+    VERIFY (thrown);
+    remove (fn.c_str ());
+    thrown = false;
+    try { png_row_writer w (fn, 0, 10); }
+    catch (const runtime_error &) { thrown = true; }
+    VERIFY (thrown);
+    remove (fn.c_str ());
+    VERIFY (is_row_writer_filename ("a.PNG"));
+    VERIFY (is_row_writer_filename ("a.jpeg"));
+    VERIFY (!is_row_writer_filename ("a.tif"));
+}
+
+int main ()
+{
+    try
+    {
+        test1 ();
+        test2 ();
+
+        return 0;
+    }
+    catch (const exception &e)
+    {
+        cerr << e.what () << endl;
+        return -1;
+    }
+}
@@ -0,0 +1,215 @@
+/// @file test_scene.cc
+/// @brief test scene files
+/// @author Jeff Perry <jeffsp@gmail.com>
+/// @version 1.0
+/// @date 2014-07-27
+
+#include "image_elements.h"
+#include "scene.h"
+#include "tile_visitor.h"
+#include "tiles.h"
+#include "verify.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+using namespace image_tiler;
+using namespace std;
+
+// an image with some detail
+rgb8_image_t get_image (const size_t rows, const size_t cols)
+{
+    rgb8_image_t img (rows, cols);
+    for (size_t r = 0; r < rows; ++r)
+        for (size_t c = 0; c < cols; ++c)
+            for (size_t k = 0; k < 3; ++k)
+                img (r, c, k) = (r * 7 + c * 13 + k * 50 + r * c / 31) % 256;
+    return img;
+}
+
+void test1 ()
+{
+    // a scene renders the same image that it was built from
+    const string fn = "test_scene_tmp.scene";
+    const size_t w = 233;
+    const size_t h = 171;
+    const point origin (w / 2.0, h / 2.0);
+    const rgb8_image_t img = get_image (h, w);
+    const tile_list tl = create_tile_list ();
+    for (auto i : { 0, 5, 6, 10, 17 })
+    {
+        const auto &t = tl[i];
+        for (auto angle : { 0.0, 27.0 })
+        {
+            const double scale = 9.0;
+            const auto locs = get_window_tile_locations (h, w, origin, scale * t.get_width (), scale * t.get_height (), angle, t.is_triangular (), get_tile_extent (t.get_polygons (), scale, angle));
+            const image_elements e = get_image_elements (img, get_intersecting_polygons (w, h, get_tiled_polygon_soup (locs, t.get_polygons (), scale, angle)));
+            scene_builder b (h, w, origin, t, scale, angle);
+            for (size_t j = 0; j < e.size (); ++j)
+                b.add (e.p[j], e.m[j]);
+            VERIFY (b.size () == e.size ());
+            b.write (fn);
+            const scene s (fn);
+            VERIFY (s.size () == e.size ());
+            VERIFY (s.get_header ().rows == h);
+            VERIFY (s.get_header ().cols == w);
+            // the file is compact
+            ifstream ifs (fn.c_str (), ios::binary | ios::ate);
+            VERIFY (static_cast<size_t> (ifs.tellg ()) < 256 + t.get_polygons ().size () * 200 + e.size () * 12);
+            // the polygons are the same
+            size_t n = 0;
+            visit_scene_polygons (s, h, w, [&] (const polygon &p, const rgb8_pixel_t &c)
+            {
+                VERIFY (p.size () == e.p[n].size ());
+                for (size_t k = 0; k < p.size (); ++k)
+                    VERIFY (p[k] == e.p[n][k]);
+                VERIFY (c == e.m[n]);
+                ++n;
+            });
+            VERIFY (n == e.size ());
+            // so the rendered images are the same
+            rgb8_image_t a (h, w);
+            fill (a, e.s, e.m);
+            rgb8_image_t c (h, w);
+            render (s, c);
+            VERIFY (a == c);
+            // the channel order of the image does not matter
+            image<unsigned char,3,buffer_container<unsigned char>,bgr_order> d (h, w);
+            render (s, d);
+            for (size_t y = 0; y < h; ++y)
+                for (size_t x = 0; x < w; ++x)
+                    for (size_t k = 0; k < 3; ++k)
+                        VERIFY (d (y, x, k) == a (y, x, k));
+        }
+    }
+    remove (fn.c_str ());
+}
+
+void test2 ()
+{
+    // scenes can be rendered at other sizes, and the visitor's polygons can be stored
+    const string fn = "test_scene_tmp.scene";
+    const size_t w = 120;
+    const size_t h = 80;
+    const tile_list tl = create_tile_list ();
+    const auto &t = tl[5];
+    const point origin (w / 2.0, h / 2.0);
+    scene_builder b (h, w, origin, t, 10.0, 15.0);
+    size_t n = 0;
+    visit_window_polygons (h, w, origin, t, 10.0, 15.0, [&] (const polygon &p)
+    {
+        b.add (p, rgb8_pixel_t { 200, 100, 50 });
+        ++n;
+    });
+    b.write (fn);
+    const scene s (fn);
+    VERIFY (s.size () == n);
+    rgb8_image_t a (2 * h, 2 * w);
+    render (s, a);
+    // the tiling covers the whole window
+    for (size_t y = 0; y < a.rows (); ++y)
+        for (size_t x = 0; x < a.cols (); ++x)
+            VERIFY (a (y, x, 0) == 200 && a (y, x, 1) == 100 && a (y, x, 2) == 50);
+    // polygons are stretched with the window
+    visit_scene_polygons (s, 2 * h, 2 * w, [&] (const polygon &p, const rgb8_pixel_t &)
+    {
+        VERIFY (p.size () == 6);
+        const rectf r = get_bounding_rectf (p);
+        VERIFY (r.maxx - r.minx > 15.0);
+    });
+    remove (fn.c_str ());
+}
+
+void test3 ()
+{
+    // bad files are rejected
+    const string fn = "test_scene_tmp.scene";
+    {
+        ofstream ofs (fn.c_str (), ios::binary);
+        ofs << "not a scene file, but it is long enough to have a header, so it should have the wrong magic number.......";
+    }
+    bool thrown = false;
+    try { scene s (fn); }
+    catch (const runtime_error &) { thrown = true; }
+    VERIFY (thrown);
+    // truncated
+    const tile_list tl = create_tile_list ();
+    scene_builder b (10, 10, point (5, 5), tl[0], 3.0, 0.0);
+    b.write (fn);
+    {
+        ifstream ifs (fn.c_str (), ios::binary);
+        string data ((istreambuf_iterator<char> (ifs)), istreambuf_iterator<char> ());
+        scene_header h;
+        memcpy (&h, data.data (), sizeof (h));
+        h.instances = 1000;
+        memcpy (&data[0], &h, sizeof (h));
+        ofstream ofs (fn.c_str (), ios::binary);
+        ofs << data;
+    }
+    thrown = false;
+    try { scene s (fn); }
+    catch (const runtime_error &) { thrown = true; }
+    VERIFY (thrown);
+    remove (fn.c_str ());
+}
+
+void test4 ()
+{
+    // painting a row at a time gives the same rows as rendering, at any size, even where polygons overlap
+    const string fn = "test_scene_tmp.scene";
+    const size_t w = 97;
+    const size_t h = 61;
+    const point origin (w / 2.0, h / 2.0);
+    const tile_list tl = create_tile_list ();
+    for (auto i : { 0, 5, 10, 13, 15, 17 })
+    {
+        const auto &t = tl[i];
+        for (auto angle : { 0.0, 33.0 })
+        {
+            scene_builder b (h, w, origin, t, 7.0, angle);
+            size_t n = 0;
+            visit_window_polygons (h, w, origin, t, 7.0, angle, [&] (const polygon &p)
+            {
+                b.add (p, rgb8_pixel_t { static_cast<unsigned char> (n * 37), static_cast<unsigned char> (n * 11), static_cast<unsigned char> (n * 5) });
+                ++n;
+            });
+            b.write (fn);
+            const scene s (fn);
+            for (auto size : { make_pair (h, w), make_pair (2 * h + 3, w + w / 2), make_pair (h / 2, w / 3) })
+            {
+                rgb8_image_t a (size.first, size.second);
+                render (s, a);
+                scene_row_painter r (s, a.rows (), a.cols ());
+                vector<unsigned char> row (a.cols () * 3);
+                for (size_t y = 0; y < a.rows (); ++y)
+                {
+                    r.paint (row.data ());
+                    VERIFY (equal (row.begin (), row.end (), &a (y, 0, 0)));
+                }
+            }
+        }
+    }
+    remove (fn.c_str ());
+}
+
+int main ()
+{
+    try
+    {
+        test1 ();
+        test2 ();
+        test3 ();
+        test4 ();
+
+        return 0;
+    }
+    catch (const exception &e)
+    {
+        cerr << e.what () << endl;
+        return -1;
+    }
+}
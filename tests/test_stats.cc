@@ -0,0 +1,159 @@
+/// @file test_stats.cc
+/// @brief test region statistics
+/// @author Jeff Perry <jeffsp@gmail.com>
+/// @version 1.0
+/// @date 2014-07-27
+
+#include "graphics.h"
+#include "image.h"
+#include "stats.h"
+#include "verify.h"
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+using namespace image_tiler;
+using namespace std;
+
+rgb8_image_t random_image (const size_t rows, const size_t cols)
+{
+    rgb8_image_t img (rows, cols);
+    for (size_t i = 0; i < img.size (); ++i)
+        img[i] = rand () % 256;
+    return img;
+}
+
+void test1 ()
+{
+    // the mean must match get_mean()
+    const rgb8_image_t img = random_image (37, 53);
+    polygon p;
+    p.push_back (point (0.1, 0.2));
+    p.push_back (point (20, 0.3));
+    p.push_back (point (20.3, 10.9));
+    p.push_back (point (5.7, 20.3));
+    p.push_back (point (-3.2, 7.6));
+    const scanlines s = clip (get_convex_polygon_scanlines (p), rect (0, 0, img.cols (), img.rows ()));
+    for (auto flags : { stats_mean, stats_all })
+    {
+        const auto r = get_region_stats (img, s, flags);
+        for (size_t k = 0; k < 3; ++k)
+            VERIFY (r.mean[k] == get_mean (img, s, k));
+    }
+}
+
+void test2 ()
+{
+    // known values
+    rgb8_image_t img (2, 4);
+    const unsigned char v[] = { 1, 2, 3, 9, 4, 7, 5, 6 };
+    for (size_t i = 0; i < 8; ++i)
+    {
+        img[i * 3 + 0] = v[i];
+        img[i * 3 + 1] = 10 * v[i];
+        img[i * 3 + 2] = 200;
+    }
+    scanlines s { scanline (0, 0, 4), scanline (1, 1, 3) };
+    const auto r = get_region_stats (img, s, stats_all);
+    // 1 2 3 9 7 5 6
+    VERIFY (r.count == 7);
+    VERIFY (r.mean[0] == 5);
+    VERIFY (r.mean[1] == 47);
+    VERIFY (r.mean[2] == 200);
+    VERIFY (r.min[0] == 1);
+    VERIFY (r.max[0] == 9);
+    VERIFY (r.min[1] == 10);
+    VERIFY (r.max[1] == 90);
+    VERIFY (r.median[0] == 5);
+    VERIFY (r.median[1] == 50);
+    VERIFY (r.median[2] == 200);
+    VERIFY (fabs (r.variance[0] - 346.0 / 49.0) < 1e-9);
+    VERIFY (r.variance[2] == 0.0);
+    // not requested
+    const auto q = get_region_stats (img, s);
+    VERIFY (q.count == 7);
+    VERIFY (q.variance[0] == 0.0);
+    VERIFY (q.max[0] == 0);
+}
+
+void test3 ()
+{
+    // empty regions
+    const rgb8_image_t img = random_image (5, 5);
+    const auto r = get_region_stats (img, scanlines (), stats_all);
+    VERIFY (r.count == 0);
+    VERIFY (r.mean[0] == 0);
+}
+
+void test4 ()
+{
+    // statistics are reported in logical channel order
+    const rgb8_image_t a = random_image (17, 19);
+    image<unsigned char,3,std::vector<unsigned char>,bgr_order> b (a.rows (), a.cols ());
+    for (size_t i = 0; i < a.rows (); ++i)
+        for (size_t j = 0; j < a.cols (); ++j)
+            for (size_t k = 0; k < 3; ++k)
+                b (i, j, k) = a (i, j, k);
+    VERIFY (a[0] == b[2]);
+    const scanlines s { scanline (1, 2, 10), scanline (2, 0, 19), scanline (9, 5, 3) };
+    for (auto flags : { stats_mean, stats_all })
+    {
+        const auto p = get_region_stats (a, s, flags);
+        const auto q = get_region_stats (b, s, flags);
+        VERIFY (p.count == q.count);
+        VERIFY (p.mean == q.mean);
+        VERIFY (p.variance == q.variance);
+        VERIFY (p.min == q.min);
+        VERIFY (p.max == q.max);
+        VERIFY (p.median == q.median);
+    }
+}
+
+void test5 ()
+{
+    // row sums give the same means as walking the pixels
+    const rgb8_image_t img = random_image (31, 47);
+    const row_sums<3> rs (img);
+    VERIFY (rs (3, 0, 1) == 0);
+    VERIFY (rs (3, 2, 1) == static_cast<unsigned> (img (3, 0, 1) + img (3, 1, 1)));
+    vector<scanlines> ps;
+    for (size_t i = 0; i < 100; ++i)
+    {
+        scanlines s;
+        for (size_t j = rand () % 5; j != 0; --j)
+        {
+            const int y = rand () % 31;
+            const int x = rand () % 46;
+            s.push_back (scanline (y, x, 1 + rand () % (47 - x)));
+        }
+        ps.push_back (s);
+    }
+    const auto a = get_region_stats (rs, ps);
+    const auto b = get_region_stats (img, ps);
+    for (size_t i = 0; i < ps.size (); ++i)
+    {
+        VERIFY (a[i].count == b[i].count);
+        VERIFY (a[i].mean == b[i].mean);
+    }
+}
+
+int main ()
+{
+    try
+    {
+        test1 ();
+        test2 ();
+        test3 ();
+        test4 ();
+        test5 ();
+
+        return 0;
+    }
+    catch (const exception &e)
+    {
+        cerr << e.what () << endl;
+        return -1;
+    }
+}
@@ -0,0 +1,166 @@
+/// @file test_svg.cc
+/// @brief test writing svg files
+/// @author Jeff Perry <jeffsp@gmail.com>
+/// @version 1.0
+/// @date 2014-07-27
+
+#include "svg.h"
+#include "tile_visitor.h"
+#include "verify.h"
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace image_tiler;
+using namespace std;
+
+// get the value of an attribute from a line of svg
+string get_attribute (const string &line, const string &name)
+{
+    const string key = " " + name + "=\"";
+    const size_t a = line.find (key);
+    VERIFY (a != string::npos);
+    const size_t b = line.find ('"', a + key.size ());
+    VERIFY (b != string::npos);
+    return line.substr (a + key.size (), b - a - key.size ());
+}
+
+// parse ' x,y x,y ...'
+points parse_points (const string &s)
+{
+    points p;
+    stringstream ss (s);
+    double x, y;
+    char comma;
+    while (ss >> x >> comma >> y)
+    {
+        VERIFY (comma == ',');
+        p.push_back (point (x, y));
+    }
+    return p;
+}
+
+// get the vertices of every polygon in a plain svg file
+vector<points> parse_svg (const string &s)
+{
+    vector<points> v;
+    stringstream ss (s);
+    string line;
+    while (getline (ss, line))
+        if (line.find ("<polygon ") == 0)
+            v.push_back (parse_points (get_attribute (line, "points")));
+    return v;
+}
+
+// get the vertices of every instance in an instanced svg file, the way a browser would draw them
+vector<points> parse_instanced_svg (const string &s)
+{
+    vector<points> shapes;
+    vector<points> v;
+    double angle = 0.0;
+    bool in_group = false;
+    stringstream ss (s);
+    string line;
+    while (getline (ss, line))
+    {
+        if (line.find ("<polygon ") == 0)
+        {
+            // definitions come before the group, in order
+            VERIFY (!in_group);
+            VERIFY (get_attribute (line, "id") == "p" + to_string (shapes.size ()));
+            shapes.push_back (parse_points (get_attribute (line, "points")));
+        }
+        else if (line.find ("<g transform=\"rotate(") == 0)
+        {
+            angle = stod (line.substr (line.find ('(') + 1)) * M_PI / 180.0;
+            in_group = true;
+        }
+        else if (line.find ("<use ") == 0)
+        {
+            VERIFY (in_group);
+            const string href = get_attribute (line, "href");
+            VERIFY (href.find ("#p") == 0);
+            const size_t k = stoul (href.substr (2));
+            VERIFY (k < shapes.size ());
+            const double x = stod (get_attribute (line, "x"));
+            const double y = stod (get_attribute (line, "y"));
+            // translate the definition, then apply the group's rotation
+            points p;
+            for (const auto &j : shapes[k])
+            {
+                const double u = j.x + x;
+                const double w = j.y + y;
+                p.push_back (point (u * cos (angle) - w * sin (angle), u * sin (angle) + w * cos (angle)));
+            }
+            v.push_back (p);
+        }
+    }
+    return v;
+}
+
+void test1 ()
+{
+    // every instance lands on the same vertices as the plain polygon that it replaces
+    const tile_list tl = create_tile_list ();
+    const size_t w = 160;
+    const size_t h = 120;
+    size_t triangular = 0;
+    for (const auto &t : tl)
+    {
+        triangular += t.is_triangular ();
+        for (auto angle : { 0.0, 17.0, 45.0, 90.0, 133.0, 270.0, -31.0 })
+        {
+            for (auto scale : { 9.0, 23.0 })
+            {
+                image_elements e;
+                visit_window_polygons (h, w, point (w / 2.0, h / 2.0), t, scale, angle, [&] (const polygon &p)
+                {
+                    e.p.push_back (p);
+                    e.m.push_back (rgb8_pixel_t { 1, 2, 3 });
+                });
+                VERIFY (!e.empty ());
+                stringstream a, b;
+                write_svg (a, w, h, e);
+                write_instanced_svg (b, w, h, t, scale, angle, e);
+                const vector<points> plain = parse_svg (a.str ());
+                const vector<points> instances = parse_instanced_svg (b.str ());
+                VERIFY (plain.size () == e.size ());
+                VERIFY (instances.size () == e.size ());
+                for (size_t i = 0; i < plain.size (); ++i)
+                {
+                    VERIFY (plain[i].size () == instances[i].size ());
+                    // both files are written with six significant digits
+                    for (size_t j = 0; j < plain[i].size (); ++j)
+                        VERIFY (fabs (plain[i][j].x - instances[i][j].x) < 1e-2 && fabs (plain[i][j].y - instances[i][j].y) < 1e-2);
+                }
+            }
+        }
+    }
+    VERIFY (triangular != 0);
+}
+
+void test2 ()
+{
+    // colors
+    VERIFY (get_svg_color (rgb8_pixel_t { 0, 0, 0 }) == "#000000");
+    VERIFY (get_svg_color (rgb8_pixel_t { 255, 16, 9 }) == "#ff1009");
+}
+
+int main ()
+{
+    try
+    {
+        test1 ();
+        test2 ();
+
+        return 0;
+    }
+    catch (const exception &e)
+    {
+        cerr << e.what () << endl;
+        return -1;
+    }
+}
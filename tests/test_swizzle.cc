@@ -0,0 +1,68 @@
+/// @file test_swizzle.cc
+/// @brief test channel swizzling
+/// @author Jeff Perry <jeffsp@gmail.com>
+/// @version 1.0
+/// @date 2014-07-27
+
+#include "swizzle.h"
+#include "verify.h"
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+using namespace image_tiler;
+using namespace std;
+
+void test1 ()
+{
+    // every length, including those that end partway through a vector
+    for (size_t n = 0; n < 40; ++n)
+    {
+        vector<unsigned char> a (n * 3);
+        for (auto &i : a)
+            i = rand ();
+        vector<unsigned char> b (n * 3);
+        swap_rb (a.data (), b.data (), n);
+        vector<unsigned char> c (n * 3);
+        swap_rb_scalar (a.data (), c.data (), n);
+        VERIFY (b == c);
+        for (size_t i = 0; i < n; ++i)
+        {
+            VERIFY (b[i * 3 + 0] == a[i * 3 + 2]);
+            VERIFY (b[i * 3 + 1] == a[i * 3 + 1]);
+            VERIFY (b[i * 3 + 2] == a[i * 3 + 0]);
+        }
+    }
+}
+
+void test2 ()
+{
+    // in place, twice, gives back the original
+    vector<unsigned char> a (1001 * 3);
+    for (auto &i : a)
+        i = rand ();
+    vector<unsigned char> b (a);
+    swap_rb (&b[0], &b[0], 1001);
+    VERIFY (b != a);
+    VERIFY (b[0] == a[2]);
+    VERIFY (b[3000] == a[3002]);
+    swap_rb (&b[0], &b[0], 1001);
+    VERIFY (b == a);
+}
+
+int main ()
+{
+    try
+    {
+        test1 ();
+        test2 ();
+
+        return 0;
+    }
+    catch (const exception &e)
+    {
+        cerr << e.what () << endl;
+        return -1;
+    }
+}
@@ -0,0 +1,84 @@
+/// @file test_tile_locations.cc
+/// @brief test window tile locations
+/// @author Jeff Perry <jeffsp@gmail.com>
+/// @version 1.0
+/// @date 2014-07-27
+
+#include "tiler.h"
+#include "tiles.h"
+#include "verify.h"
+#include <iostream>
+#include <stdexcept>
+
+using namespace image_tiler;
+using namespace std;
+
+bool operator== (const polygon &a, const polygon &b)
+{
+    if (a.size () != b.size () || a.get_polygon_index () != b.get_polygon_index ())
+        return false;
+    for (size_t i = 0; i < a.size (); ++i)
+        if (!(a[i] == b[i]))
+            return false;
+    return true;
+}
+
+void test1 ()
+{
+    // a square lattice that is not rotated only keeps the tiles that touch the padded window
+    polygon q { point (0, 0), point (1, 0), point (1, 1), point (0, 1) };
+    q.set_tile_index (0);
+    q.set_polygon_index (0);
+    const polygons square (1, q);
+    const rectf e = get_tile_extent (square, 10.0, 0.0);
+    VERIFY (e.minx == 0.0 && e.miny == 0.0 && e.maxx == 10.0 && e.maxy == 10.0);
+    const auto l = get_window_tile_locations (30, 40, point (0, 0), 10.0, 10.0, 0.0, false, e);
+    // x in [-11, 41], y in [-11, 31]
+    VERIFY (l.size () == 6 * 5);
+    VERIFY (l.front () == point (-10, -10));
+    VERIFY (l.back () == point (40, 30));
+}
+
+void test2 ()
+{
+    // the same polygons intersect the window, and there are fewer locations
+    const tile_list tl = create_tile_list ();
+    for (const auto &t : tl)
+    {
+        for (auto scale : { 3.0, 17.0 })
+        {
+            for (auto angle : { 0.0, 10.0, 45.0, 133.0 })
+            {
+                const size_t w = 257;
+                const size_t h = 119;
+                const point origin (w / 2.0 + 3.25, h / 2.0 - 7.5);
+                const double tw = scale * t.get_width ();
+                const double th = scale * t.get_height ();
+                const auto a = get_tile_locations (h, w, origin, tw, th, angle, t.is_triangular ());
+                const auto b = get_window_tile_locations (h, w, origin, tw, th, angle, t.is_triangular (), get_tile_extent (t.get_polygons (), scale, angle));
+                VERIFY (b.size () < a.size ());
+                const auto pa = get_intersecting_polygons (w, h, get_tiled_polygons (a, t.get_polygons (), scale, angle));
+                const auto pb = get_intersecting_polygons (w, h, get_tiled_polygons (b, t.get_polygons (), scale, angle));
+                VERIFY (pa.size () == pb.size ());
+                for (size_t i = 0; i < pa.size (); ++i)
+                    VERIFY (pa[i] == pb[i]);
+            }
+        }
+    }
+}
+
+int main ()
+{
+    try
+    {
+        test1 ();
+        test2 ();
+
+        return 0;
+    }
+    catch (const exception &e)
+    {
+        cerr << e.what () << endl;
+        return -1;
+    }
+}
@@ -0,0 +1,198 @@
+/// @file test_tile_visitor.cc
+/// @brief test visiting the polygons of a tiling
+/// @author Jeff Perry <jeffsp@gmail.com>
+/// @version 1.0
+/// @date 2014-07-27
+
+#include "tile_visitor.h"
+#include "verify.h"
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <vector>
+
+using namespace image_tiler;
+using namespace std;
+
+bool operator== (const polygon &a, const polygon &b)
+{
+    if (a.size () != b.size ()
+        || a.get_tile_index () != b.get_tile_index ()
+        || a.get_polygon_index () != b.get_polygon_index ())
+        return false;
+    for (size_t i = 0; i < a.size (); ++i)
+        if (!(a[i] == b[i]))
+            return false;
+    return true;
+}
+
+void test1 ()
+{
+    // visiting gives the same polygons and scanlines as the materialized stages
+    const tile_list tl = create_tile_list ();
+    for (const auto &t : tl)
+    {
+        for (auto scale : { 2.5, 13.0 })
+        {
+            for (auto angle : { 0.0, 30.0, 291.0 })
+            {
+                const size_t w = 211;
+                const size_t h = 157;
+                const point origin (w / 2.0 - 1.5, h / 2.0 + 4.0);
+                const auto locs = get_window_tile_locations (h, w, origin, scale * t.get_width (), scale * t.get_height (), angle, t.is_triangular (), get_tile_extent (t.get_polygons (), scale, angle));
+                const auto p = get_intersecting_polygons (w, h, get_tiled_polygons (locs, t.get_polygons (), scale, angle));
+                const auto s = clip_scanlines (w, h, get_polygon_scanlines (p));
+                size_t i = 0;
+                visit_window_polygons (h, w, origin, t, scale, angle, [&] (const polygon &q)
+                {
+                    VERIFY (i < p.size ());
+                    VERIFY (q == p[i]);
+                    ++i;
+                });
+                VERIFY (i == p.size ());
+                i = 0;
+                visit_window_scanlines (h, w, origin, t, scale, angle, [&] (const polygon &q, const scanlines &r)
+                {
+                    VERIFY (q == p[i]);
+                    VERIFY (r == s[i]);
+                    ++i;
+                });
+                VERIFY (i == p.size ());
+            }
+        }
+    }
+}
+
+void test2 ()
+{
+    // nothing is visited outside of the window
+    const tile_list tl = create_tile_list ();
+    size_t n = 0;
+    visit_window_scanlines (0, 0, point (0, 0), tl[10], 10.0, 0.0, [&] (const polygon &, const scanlines &s)
+    {
+        VERIFY (s.empty ());
+        ++n;
+    });
+    VERIFY (n == 0);
+}
+
+void test3 ()
+{
+    // sweeping gives the same polygons as visiting, from top to bottom
+    const tile_list tl = create_tile_list ();
+    for (const auto &t : tl)
+    {
+        for (auto scale : { 2.5, 13.0 })
+        {
+            for (auto angle : { 0.0, 30.0, 90.0, 180.0, 291.0 })
+            {
+                const size_t w = 211;
+                const size_t h = 157;
+                const point origin (w / 2.0 - 1.5, h / 2.0 + 4.0);
+                vector<polygon> p;
+                map<size_t,size_t> index;
+                visit_window_polygons (h, w, origin, t, scale, angle, [&] (const polygon &q)
+                {
+                    index[q.get_tile_index ()] = p.size ();
+                    p.push_back (q);
+                });
+                vector<bool> seen (p.size ());
+                window_polygon_sweep sweep (h, w, origin, t, scale, angle);
+                for (int y = -3; y <= static_cast<int> (h) + 7; y += 5)
+                {
+                    sweep.visit (y, [&] (const polygon &q)
+                    {
+                        VERIFY (index.count (q.get_tile_index ()) == 1);
+                        const size_t i = index[q.get_tile_index ()];
+                        VERIFY (!seen[i]);
+                        VERIFY (q == p[i]);
+                        seen[i] = true;
+                    });
+                    // everything above y has been visited
+                    for (size_t i = 0; i < p.size (); ++i)
+                    {
+                        const scanlines s = get_convex_polygon_scanlines (p[i]);
+                        VERIFY (seen[i] || s.empty () || s[0].y >= y);
+                    }
+                }
+                VERIFY (find (seen.begin (), seen.end (), false) == seen.end ());
+            }
+        }
+    }
+}
+
+void test4 ()
+{
+    // tiles can be placed in any order
+    const tile_list tl = create_tile_list ();
+    const size_t w = 97;
+    const size_t h = 131;
+    const window_tile_placer placer (h, w, point (w / 2.0, h / 2.0), tl[3], 6.0, 23.0);
+    polygons a (placer.get_polygons ());
+    polygons b (placer.get_polygons ());
+    size_t n = 0;
+    placer.visit ([&] (const size_t i, const point &location)
+    {
+        VERIFY (i == n++);
+        placer.place (i, location, a);
+        const size_t j = placer.size () - 1 - i;
+        placer.place (j, placer.get_location (j), b);
+        placer.place (i, placer.get_location (i), b);
+        for (size_t k = 0; k < a.size (); ++k)
+            VERIFY (a[k] == b[k]);
+    });
+    VERIFY (n == placer.size ());
+    VERIFY (n != 0);
+}
+
+void test5 ()
+{
+    // painting a row at a time gives the same rows as filling the scanlines in order, even where polygons overlap
+    const tile_list tl = create_tile_list ();
+    const size_t w = 97;
+    const size_t h = 61;
+    for (auto i : { 0, 5, 10, 13, 15, 17 })
+    {
+        for (auto angle : { 0.0, 33.0, 250.0 })
+        {
+            const point origin (w / 2.0 + 0.5, h / 2.0 - 2.0);
+            rgb8_image_t a (h, w);
+            vector<rgb8_pixel_t> m;
+            visit_window_scanlines (h, w, origin, tl[i], 6.5, angle, [&] (const polygon &, const scanlines &s)
+            {
+                const size_t n = m.size ();
+                m.push_back (rgb8_pixel_t { static_cast<unsigned char> (n * 37), static_cast<unsigned char> (n * 11), static_cast<unsigned char> (n * 5) });
+                const span_filler<rgb8_image_t> f (a, m.back ());
+                for (const auto &j : s)
+                    f.fill (a, j);
+            });
+            window_row_painter r (h, w, origin, tl[i], 6.5, angle, m);
+            vector<unsigned char> row (w * 3);
+            for (size_t y = 0; y < h; ++y)
+            {
+                r.paint (row.data ());
+                VERIFY (equal (row.begin (), row.end (), &a (y, 0, 0)));
+            }
+        }
+    }
+}
+
+int main ()
+{
+    try
+    {
+        test1 ();
+        test2 ();
+        test3 ();
+        test4 ();
+        test5 ();
+
+        return 0;
+    }
+    catch (const exception &e)
+    {
+        cerr << e.what () << endl;
+        return -1;
+    }
+}
@@ -0,0 +1,393 @@
+/// @file tile_visitor.h
+/// @brief visit the polygons and scanlines of a tiling without storing them
+/// @author Jeff Perry <jeffsp@gmail.com>
+/// @version 1.0
+/// @date 2014-07-27
+
+#ifndef TILE_VISITOR_H
+#define TILE_VISITOR_H
+
+#include "geometry.h"
+#include "graphics.h"
+#include "tiler.h"
+#include "tiles.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace image_tiler
+{
+
+/// @brief place the tiles of a tiling whose polygons may intersect a window
+///
+/// The tiles are numbered in the order of their lattice rows, and they can be placed in any order.  The placed
+/// polygons, their indexes and the test for whether they intersect the window are the same as the ones of
+/// visit_window_polygons ().
+class window_tile_placer
+{
+    public:
+    /// @brief constructor
+    ///
+    /// @param rows rows in window
+    /// @param cols cols in window
+    /// @param origin center point of window
+    /// @param t the tile
+    /// @param scale scale of the tile
+    /// @param angle angle of the tile
+    window_tile_placer (const size_t rows, const size_t cols, const point &origin, const convex_uniform_tile &t, const double scale, const double angle)
+        : polys (t.get_polygons ())
+        , extent (get_tile_extent (polys, scale, angle))
+        , l (get_window_lattice_rows (rows, cols, origin, scale * t.get_width (), scale * t.get_height (), angle, t.is_triangular (), extent))
+        , window (0, 0, cols, rows)
+        // the same transforms as visit_tile_locations () and get_tiled_polygons ()
+        , lattice (translation (origin) * rotation (angle) * scaling (scale * t.get_width (), scale * t.get_height ()))
+        , m (rotation (angle) * scaling (scale, scale))
+    {
+        first.reserve (l.size () + 1);
+        first.push_back (0);
+        for (const auto &i : l)
+            first.push_back (first.back () + i.size ());
+    }
+    /// @brief get the number of tiles
+    size_t size () const { return first.back (); }
+    /// @brief get the tile's polygons, before they are placed
+    const polygons &get_polygons () const { return polys; }
+    /// @brief get the bounding rectangle of the polygons of one tile, relative to its location
+    const rectf &get_extent () const { return extent; }
+    /// @brief get the lattice rows
+    const lattice_rows &get_lattice_rows () const { return l; }
+    /// @brief get the number of the first tile in a lattice row
+    size_t get_first_tile (const size_t r) const { return first[r]; }
+    /// @brief get the location of the j'th tile in a lattice row
+    point get_location (const size_t r, const size_t j) const
+    {
+        // the same as stepping through the row one column at a time
+        return lattice (point (l[r].k1 + j - l[r].offset, l[r].v));
+    }
+    /// @brief get the location of a tile
+    point get_location (const size_t i) const
+    {
+        assert (i < size ());
+        const size_t r = std::upper_bound (first.begin (), first.end (), i) - first.begin () - 1;
+        return get_location (r, i - first[r]);
+    }
+    /// @brief place the polygons of a tile
+    ///
+    /// @param i the tile
+    /// @param location the location of the tile
+    /// @param placed a copy of the tile's polygons, which are overwritten
+    void place (const size_t i, const point &location, polygons &placed) const
+    {
+        assert (placed.size () == polys.size ());
+        const affine2 placement = translation (location) * m;
+        for (size_t j = 0; j < polys.size (); ++j)
+        {
+            polygon &p = placed[j];
+            if (!p.empty ())
+                transform (placement, &polys[j][0], &p[0], p.size ());
+            p.set_tile_index (i * polys.size () + j);
+            p.set_polygon_index (j);
+        }
+    }
+    /// @brief check if a placed polygon intersects the window, with the same test as get_intersecting_polygons ()
+    bool in_window (const polygon &p) const
+    {
+        return intersects (window, get_bounding_rect (p));
+    }
+    /// @brief visit the tiles in order
+    ///
+    /// @param f functor that is called with the number and the location of each tile
+    template<typename F>
+    void visit (F f) const
+    {
+        size_t i = 0;
+        for (size_t r = 0; r < l.size (); ++r)
+            for (size_t j = 0; j < l[r].size (); ++j)
+                f (i++, get_location (r, j));
+    }
+    private:
+    const polygons polys;
+    const rectf extent;
+    const lattice_rows l;
+    const rect window;
+    const affine2 lattice;
+    const affine2 m;
+    std::vector<size_t> first;
+};
+
+/// @brief visit the polygons of a tiling that intersect a window, one at a time
+///
+/// @param rows rows in window
+/// @param cols cols in window
+/// @param origin center point of window
+/// @param t the tile
+/// @param scale scale of the tile
+/// @param angle angle of the tile
+/// @param f functor that is called with each polygon
+///
+/// The polygons are generated from the lattice as they are visited, so nothing is stored but the lattice rows and one
+/// tile's worth of polygons, which are reused.  The polygons, their indexes and their order are the same as the ones
+/// that get_intersecting_polygons () returns for the polygons of get_window_tile_locations ().  A polygon that is
+/// passed to f is only valid until f returns.
+template<typename F>
+void visit_window_polygons (const size_t rows, const size_t cols, const point &origin, const convex_uniform_tile &t, const double scale, const double angle, F f)
+{
+    const window_tile_placer placer (rows, cols, origin, t, scale, angle);
+    // one tile's worth of polygons, which are overwritten at each location
+    polygons placed (placer.get_polygons ());
+    placer.visit ([&] (const size_t i, const point &location)
+    {
+        placer.place (i, location, placed);
+        for (const auto &p : placed)
+            if (placer.in_window (p))
+                f (p);
+    });
+}
+
+/// @brief visit the polygons of a tiling that intersect a window, along with their clipped scanlines
+///
+/// @param rows rows in window
+/// @param cols cols in window
+/// @param origin center point of window
+/// @param t the tile
+/// @param scale scale of the tile
+/// @param angle angle of the tile
+/// @param f functor that is called with each polygon and its scanlines
+///
+/// Rasterizing and clipping are fused with generating the polygons, and the scanline buffers are reused, so memory
+/// use does not depend on the number of polygons.  The scanlines are the same as the ones that clip_scanlines ()
+/// returns for get_polygon_scanlines ().  The arguments that are passed to f are only valid until f returns.
+template<typename F>
+void visit_window_scanlines (const size_t rows, const size_t cols, const point &origin, const convex_uniform_tile &t, const double scale, const double angle, F f)
+{
+    const rect window (0, 0, cols, rows);
+    scanlines s;
+    scanlines clipped;
+    visit_window_polygons (rows, cols, origin, t, scale, angle, [&] (const polygon &p)
+    {
+        s.clear ();
+        get_convex_polygon_scanlines (p, s);
+        clipped.clear ();
+        clip (s, window, clipped);
+        f (p, static_cast<const scanlines &> (clipped));
+    });
+}
+
+/// @brief paint the rows of a tiling one at a time, without an image
+///
+/// The colors belong to the polygons that visit_window_polygons () visits, in the same order, and each row is the same
+/// as the corresponding row of an image whose clipped scanlines were filled in that order.  The tiles are sorted by the
+/// first row that their polygons might cover.  A tile is only placed and rasterized when that row is painted, and the
+/// scanlines of its polygons are dropped after their last row, so besides the active polygons, only three numbers per
+/// tile are kept.  The rows must be painted from top to bottom.
+class window_row_painter
+{
+    public:
+    /// @brief constructor
+    ///
+    /// @param rows rows in window
+    /// @param cols cols in window
+    /// @param origin center point of window
+    /// @param t the tile
+    /// @param scale scale of the tile
+    /// @param angle angle of the tile
+    /// @param m one color for each polygon
+    window_row_painter (const size_t rows, const size_t cols, const point &origin, const convex_uniform_tile &t, const double scale, const double angle, const std::vector<rgb8_pixel_t> &m)
+        : placer (rows, cols, origin, t, scale, angle)
+        , placed (placer.get_polygons ())
+        , m (m)
+        , cols (cols)
+        , window (0, 0, cols, rows)
+        , next (0)
+        , y (0)
+    {
+        size_t i = 0;
+        placer.visit ([&] (const size_t tile, const point &location)
+        {
+            placer.place (tile, location, placed);
+            const size_t first = i;
+            double miny = std::numeric_limits<double>::max ();
+            for (const auto &p : placed)
+            {
+                if (!placer.in_window (p))
+                    continue;
+                ++i;
+                miny = std::min (miny, get_bounding_rectf (p).miny);
+            }
+            if (i == first || miny >= rows)
+                return;
+            // starting early does no harm, so round down
+            starts.push_back (tile_start { static_cast<uint32_t> (std::max (0.0, ::floor (miny))), static_cast<uint32_t> (tile), static_cast<uint32_t> (first) });
+        });
+        if (i != m.size ())
+            throw std::runtime_error ("there is not one color for each polygon");
+        std::sort (starts.begin (), starts.end (), [] (const tile_start &a, const tile_start &b)
+            { return a.row < b.row || (a.row == b.row && a.tile < b.tile); });
+    }
+    /// @brief paint the next row
+    ///
+    /// @param dst cols interlaced RGB pixels
+    void paint (unsigned char *dst)
+    {
+        std::memset (dst, 0, cols * 3);
+        // place the tiles that start on this row, keeping the active polygons in painting order
+        const size_t n = active.size ();
+        for (; next < starts.size () && starts[next].row <= y; ++next)
+        {
+            const tile_start &t = starts[next];
+            placer.place (t.tile, placer.get_location (t.tile), placed);
+            size_t i = t.first;
+            for (const auto &p : placed)
+            {
+                if (!placer.in_window (p))
+                    continue;
+                active.push_back (active_polygon ());
+                active_polygon &a = active.back ();
+                a.i = i++;
+                a.cursor = 0;
+                s.clear ();
+                get_convex_polygon_scanlines (p, s);
+                clip (s, window, a.s);
+            }
+        }
+        if (active.size () != n)
+        {
+            const auto by_index = [] (const active_polygon &a, const active_polygon &b) { return a.i < b.i; };
+            std::sort (active.begin () + n, active.end (), by_index);
+            std::inplace_merge (active.begin (), active.begin () + n, active.end (), by_index);
+        }
+        size_t k = 0;
+        for (size_t i = 0; i < active.size (); ++i)
+        {
+            active_polygon &a = active[i];
+            while (a.cursor < a.s.size () && a.s[a.cursor].y < static_cast<int> (y))
+                ++a.cursor;
+            if (a.cursor < a.s.size () && a.s[a.cursor].y == static_cast<int> (y))
+            {
+                const unsigned char q[3] = { m[a.i][0], m[a.i][1], m[a.i][2] };
+                const pixel_pattern<3> f (q);
+                for (; a.cursor < a.s.size () && a.s[a.cursor].y == static_cast<int> (y); ++a.cursor)
+                    f.fill (dst + a.s[a.cursor].x * 3, a.s[a.cursor].len);
+            }
+            // keep the polygon if it has more rows
+            if (a.cursor < a.s.size ())
+            {
+                if (k != i)
+                    active[k] = std::move (a);
+                ++k;
+            }
+        }
+        active.resize (k);
+        ++y;
+    }
+    private:
+    struct tile_start
+    {
+        uint32_t row;
+        uint32_t tile;
+        // the index of the tile's first polygon
+        uint32_t first;
+    };
+    struct active_polygon
+    {
+        uint32_t i;
+        uint32_t cursor;
+        scanlines s;
+    };
+    const window_tile_placer placer;
+    polygons placed;
+    const std::vector<rgb8_pixel_t> &m;
+    const size_t cols;
+    const rect window;
+    std::vector<tile_start> starts;
+    size_t next;
+    size_t y;
+    std::vector<active_polygon> active;
+    scanlines s;
+};
+
+/// @brief visit the polygons of a tiling that intersect a window, from the top of the window to the bottom
+///
+/// Along a lattice row, the tops of the tiles move monotonically up or down the window, so the lattice rows are merged
+/// with a heap that holds the next tile of each row.  Only the heap is stored, so memory use depends on the number of
+/// lattice rows, not on the number of polygons.  The polygons and their indexes are the same as the ones of
+/// visit_window_polygons (), but they are visited in a different order.
+class window_polygon_sweep
+{
+    public:
+    /// @brief constructor
+    ///
+    /// @param rows rows in window
+    /// @param cols cols in window
+    /// @param origin center point of window
+    /// @param t the tile
+    /// @param scale scale of the tile
+    /// @param angle angle of the tile
+    window_polygon_sweep (const size_t rows, const size_t cols, const point &origin, const convex_uniform_tile &t, const double scale, const double angle)
+        : placer (rows, cols, origin, t, scale, angle)
+        , placed (placer.get_polygons ())
+    {
+        const lattice_rows &l = placer.get_lattice_rows ();
+        done.resize (l.size ());
+        descending.resize (l.size ());
+        for (size_t r = 0; r < l.size (); ++r)
+        {
+            descending[r] = placer.get_location (r, l[r].size () - 1).y < placer.get_location (r, 0).y;
+            heap.push (std::make_pair (get_top (r), r));
+        }
+    }
+    /// @brief visit the polygons of the tiles that start above a row, which have not been visited yet
+    ///
+    /// @param y the row
+    /// @param f functor that is called with each polygon
+    ///
+    /// Afterwards, every polygon with a scanline above row y has been visited.  Some polygons that start lower down are
+    /// visited along with the rest of their tile.  A polygon that is passed to f is only valid until f returns.
+    template<typename F>
+    void visit (const int y, F f)
+    {
+        // a pixel of slack for rounding the vertices
+        while (!heap.empty () && heap.top ().first < y + 1.0)
+        {
+            const size_t r = heap.top ().second;
+            heap.pop ();
+            const size_t j = get_column (r);
+            const size_t i = placer.get_first_tile (r) + j;
+            placer.place (i, placer.get_location (r, j), placed);
+            for (const auto &p : placed)
+                if (placer.in_window (p))
+                    f (p);
+            if (++done[r] < placer.get_lattice_rows ()[r].size ())
+                heap.push (std::make_pair (get_top (r), r));
+        }
+    }
+    private:
+    // the column of the next tile in a lattice row
+    size_t get_column (const size_t r) const
+    {
+        return descending[r] ? placer.get_lattice_rows ()[r].size () - 1 - done[r] : done[r];
+    }
+    // the top of the next tile in a lattice row
+    double get_top (const size_t r) const
+    {
+        return placer.get_location (r, get_column (r)).y + placer.get_extent ().miny;
+    }
+    const window_tile_placer placer;
+    polygons placed;
+    std::vector<size_t> done;
+    std::vector<bool> descending;
+    typedef std::pair<double,size_t> next_tile;
+    std::priority_queue<next_tile,std::vector<next_tile>,std::greater<next_tile>> heap;
+};
+
+} // namespace image_tiler
+
+#endif // TILE_VISITOR_H
@@ -8,6 +8,13 @@
 #define TILER_H
 
 #include "geometry.h"
+#include "graphics.h"
+#include "polygon_soup.h"
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <limits>
+#include <vector>
 
 namespace image_tiler
 {
@@ -68,18 +75,23 @@ points get_tile_locations (const size_t rows,
 polygons get_tiled_polygons (const points &tile_locations, const polygons &polys, const double scale, const double angle)
 {
     polygons all_polys;
+    all_polys.reserve (tile_locations.size () * polys.size ());
+    // scale and rotate, the translation is filled in at each location
+    const affine2 m = rotation (angle) * scaling (scale, scale);
 
     // for each tile location
     size_t tile_index = 0;
     for (const auto &offset : tile_locations)
     {
+        const affine2 t = translation (offset) * m;
         // for each polygon in a tile
         size_t polygon_index = 0;
         for (const auto &tile_poly : polys)
         {
             // convert to window coordinates
             // save off a transformed poly
-            polygon p = affine (tile_poly, scale, scale, angle, offset);
+            polygon p (tile_poly);
+            transform (t, p);
             p.set_tile_index (tile_index++);
             p.set_polygon_index (polygon_index++);
             all_polys.push_back (p);
@@ -88,6 +100,213 @@ polygons get_tiled_polygons (const points &tile_locations, const polygons &polys
     return all_polys;
 }
 
+/// @brief get tiled polygons for the specified locations, in flat storage
+///
+/// @param tile_locations the tile locations
+/// @param polys polygons contained in one tile
+/// @param scale scale of the tile
+/// @param angle angle of the tile
+///
+/// @return all the polygons for all the locations
+///
+/// The result is the same as get_tiled_polygons (), but there are a handful of allocations instead of one per polygon,
+/// and each tile's vertices are transformed in one batch.
+polygon_soup get_tiled_polygon_soup (const points &tile_locations, const polygons &polys, const double scale, const double angle)
+{
+    // the indexes of the tile's polygons are not used
+    polygon_soup shape;
+    for (const auto &p : polys)
+    {
+        polygon q (p);
+        q.set_tile_index (0);
+        q.set_polygon_index (0);
+        shape.push_back (q);
+    }
+    polygon_soup all_polys;
+    all_polys.reserve (tile_locations.size () * shape.size (), tile_locations.size () * shape.vertex_count ());
+    const affine2 m = rotation (angle) * scaling (scale, scale);
+    size_t tile_index = 0;
+    for (const auto &offset : tile_locations)
+    {
+        all_polys.append (shape, translation (offset) * m, tile_index);
+        tile_index += shape.size ();
+    }
+    return all_polys;
+}
+
+/// @brief get the bounding rectangle of the polygons of one tile, relative to its location
+///
+/// @param polys polygons contained in one tile
+/// @param scale scale of the tile
+/// @param angle angle of the tile
+///
+/// @return the bounding rectangle, in window coordinates
+rectf get_tile_extent (const polygons &polys, const double scale, const double angle)
+{
+    polygon all;
+    for (const auto &p : get_tiled_polygons (points (1, point (0, 0)), polys, scale, angle))
+        for (const auto &i : p)
+            all.push_back (i);
+    return get_bounding_rectf (all);
+}
+
+/// @brief the tile locations in one row of the lattice
+///
+/// The locations are at lattice coordinates (k - offset, v), for k in [k1, k2].
+struct lattice_row
+{
+    double v;
+    double offset;
+    double k1;
+    double k2;
+    size_t size () const { return k2 - k1 + 1; }
+};
+
+typedef std::vector<lattice_row> lattice_rows;
+
+/// @brief get the lattice rows of the tiles whose polygons may intersect a rectangular window
+///
+/// @param row rows in window
+/// @param cols cols in window
+/// @param origin center point of window
+/// @param tile_width tile size
+/// @param tile_height tile size
+/// @param angle rotation angle in degrees
+/// @param is_triangular true if tiles are triangular
+/// @param extent bounding rectangle of the polygons of one tile, from get_tile_extent ()
+///
+/// @return the non-empty lattice rows, in ascending order
+///
+/// A tile is kept if its extent, placed at its location, comes within a pixel of the window.  This keeps every polygon
+/// that get_intersecting_polygons () would keep from the locations returned by get_tile_locations (), but the lattice
+/// is not enumerated outside of the window.  In the lattice, the locations that are kept lie in a parallelogram, so
+/// the range of columns in each lattice row is solved for directly.
+lattice_rows get_window_lattice_rows (const size_t rows,
+    const size_t cols,
+    const point &origin,
+    const double tile_width,
+    const double tile_height,
+    const double angle,
+    const bool is_triangular,
+    const rectf &extent)
+{
+    // locations whose extent comes within a pixel of the window, in window coordinates
+    const double pad = 1.0;
+    const double x1 = -pad - extent.maxx;
+    const double x2 = cols + pad - extent.minx;
+    const double y1 = -pad - extent.maxy;
+    const double y2 = rows + pad - extent.miny;
+    const double r = deg_to_rad (angle);
+    const double c = cos (r);
+    const double s = sin (r);
+    // the lattice rows that the rectangle spans
+    double vmin = std::numeric_limits<double>::max ();
+    double vmax = std::numeric_limits<double>::lowest ();
+    for (auto x : { x1, x2 })
+    {
+        for (auto y : { y1, y2 })
+        {
+            const double v = (-(x - origin.x) * s + (y - origin.y) * c) / tile_height;
+            vmin = std::min (vmin, v);
+            vmax = std::max (vmax, v);
+        }
+    }
+    // if the tiles are layed out triangularly, odd numbered rows have an x offset of -0.5
+    const double odd_offset = is_triangular ? 0.5 : 0.0;
+    lattice_rows l;
+    for (double v = ::ceil (vmin); v <= ::floor (vmax); v += 1.0)
+    {
+        // in this row, x = ax * u + bx and y = ay * u + by
+        const double ax = tile_width * c;
+        const double bx = origin.x - v * tile_height * s;
+        const double ay = tile_width * s;
+        const double by = origin.y + v * tile_height * c;
+        double umin = std::numeric_limits<double>::lowest ();
+        double umax = std::numeric_limits<double>::max ();
+        bool empty = false;
+        // clamp u to the values where a * u + b is in [lo, hi]
+        auto clamp = [&] (const double a, const double b, const double lo, const double hi)
+        {
+            if (a == 0.0)
+            {
+                empty = empty || b < lo || b > hi;
+                return;
+            }
+            double u1 = (lo - b) / a;
+            double u2 = (hi - b) / a;
+            if (u2 < u1)
+                std::swap (u1, u2);
+            umin = std::max (umin, u1);
+            umax = std::min (umax, u2);
+        };
+        clamp (ax, bx, x1, x2);
+        clamp (ay, by, y1, y2);
+        if (empty || umax < umin)
+            continue;
+        const bool is_odd = static_cast<int> (abs (v)) & 1;
+        const double offset = is_odd * odd_offset;
+        const double k1 = ::ceil (umin + offset);
+        const double k2 = ::floor (umax + offset);
+        if (k2 < k1)
+            continue;
+        l.push_back (lattice_row { v, offset, k1, k2 });
+    }
+    return l;
+}
+
+/// @brief visit the tile locations in some lattice rows, one at a time
+///
+/// @param l the lattice rows
+/// @param tile_width tile size
+/// @param tile_height tile size
+/// @param angle rotation angle in degrees
+/// @param origin center point of window
+/// @param f functor that is called with each location
+///
+/// The trig functions are only evaluated once, and each location is computed from its lattice coordinates with the
+/// same transform as get_tile_locations (), so the locations are bit for bit the same as the ones it returns.
+template<typename F>
+void visit_tile_locations (const lattice_rows &l, const double tile_width, const double tile_height, const double angle, const point &origin, F f)
+{
+    const affine2 m = translation (origin) * rotation (angle) * scaling (tile_width, tile_height);
+    for (const auto &i : l)
+        for (double k = i.k1; k <= i.k2; k += 1.0)
+            f (m (point (k - i.offset, i.v)));
+}
+
+/// @brief get locations of the tiles whose polygons may intersect a rectangular window
+///
+/// @param row rows in window
+/// @param cols cols in window
+/// @param origin center point of window
+/// @param tile_width tile size
+/// @param tile_height tile size
+/// @param angle rotation angle in degrees
+/// @param is_triangular true if tiles are triangular
+/// @param extent bounding rectangle of the polygons of one tile, from get_tile_extent ()
+///
+/// @return container of tile location points
+///
+/// See get_window_lattice_rows () and visit_tile_locations ().
+points get_window_tile_locations (const size_t rows,
+    const size_t cols,
+    const point &origin,
+    const double tile_width,
+    const double tile_height,
+    const double angle,
+    const bool is_triangular,
+    const rectf &extent)
+{
+    const lattice_rows l = get_window_lattice_rows (rows, cols, origin, tile_width, tile_height, angle, is_triangular, extent);
+    size_t n = 0;
+    for (const auto &i : l)
+        n += i.size ();
+    points p;
+    p.reserve (n);
+    visit_tile_locations (l, tile_width, tile_height, angle, origin, [&p] (const point &q) { p.push_back (q); });
+    return p;
+}
+
 /// @brief get polygons that intersect a window
 ///
 /// @param w width of window
@@ -112,21 +331,51 @@ polygons get_intersecting_polygons (const unsigned w, const unsigned h, const po
     return l;
 }
 
+/// @brief get polygons that intersect a window
+///
+/// @param w width of window
+/// @param h height of window
+/// @param p polygons
+///
+/// @return  intersecting polys
+///
+/// The result is the same as for polygons, but the stored bounding rectangles are used instead of recomputing them.
+polygon_soup get_intersecting_polygons (const unsigned w, const unsigned h, const polygon_soup &p)
+{
+    const rect window (0, 0, w, h);
+    std::vector<uint32_t> keep;
+    size_t n = 0;
+    for (size_t i = 0; i < p.size (); ++i)
+    {
+        if (intersects (window, get_bounding_rect (p[i].get_bounds ())))
+        {
+            keep.push_back (i);
+            n += p[i].size ();
+        }
+    }
+    // copy them without growing the soup
+    polygon_soup l;
+    l.reserve (keep.size (), n);
+    for (auto i : keep)
+        l.push_back (p[i]);
+    return l;
+}
+
 typedef std::vector<scanlines> polygon_scanlines;
 
 /// @brief get raster scanlines associated with some polygons
 ///
-/// @param p polygons
+/// @param p polygons, or a polygon soup
 ///
 /// @return container of container of scanlines
-polygon_scanlines get_polygon_scanlines (const polygons &p)
+template<typename PS>
+polygon_scanlines get_polygon_scanlines (const PS &p)
 {
     polygon_scanlines ps (p.size ());
-    transform (p.begin (), p.end (), ps.begin (),
-        [] (const polygon &a)
-        {
-            return get_convex_polygon_scanlines (a);
-        });
+    // each polygon is independent, so the result does not depend on the number of threads
+#pragma omp parallel for schedule (dynamic, 256)
+    for (size_t i = 0; i < p.size (); ++i)
+        get_convex_polygon_scanlines (p[i], ps[i]);
     return ps;
 }
 
@@ -142,14 +391,12 @@ polygon_scanlines clip_scanlines (const unsigned w, const unsigned h, const poly
     // get the clipping boundary
     const rect window { 0, 0, w, h };
     polygon_scanlines ps (s.size ());
-    transform (s.begin (), s.end (), ps.begin (),
-        [&] (const scanlines &a)
-        {
-            // clip the scanlines to the window
-            //
-            // it's OK to have an empty container of scanlines
-            return clip (a, window);
-        });
+    // clip the scanlines to the window
+    //
+    // it's OK to have an empty container of scanlines
+#pragma omp parallel for schedule (dynamic, 256)
+    for (size_t i = 0; i < s.size (); ++i)
+        ps[i] = clip (s[i], window);
     return ps;
 }
 
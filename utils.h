@@ -8,11 +8,16 @@
 #define UTILS_H
 
 #include <cassert>
+#include <cctype>
 #include <cmath>
+#include <string>
 #include <vector>
 #include <iostream>
 #include <sys/time.h>
 #include <stdlib.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 namespace image_tiler
 {
@@ -37,6 +42,47 @@ T clip (T x, T min, T max)
     return x < min ? min : (x > max) ? max : x;
 }
 
+/// @brief get the lower case extension of a filename, without the '.'
+std::string get_extension (const std::string &fn)
+{
+    const size_t n = fn.rfind ('.');
+    if (n == std::string::npos)
+        return std::string ();
+    std::string ext = fn.substr (n + 1);
+    for (auto &c : ext)
+        c = tolower (c);
+    return ext;
+}
+
+/// @brief set the number of threads used by parallel sections, 0 means use the default
+void set_thread_count (const unsigned n)
+{
+#ifdef _OPENMP
+    if (n != 0)
+        omp_set_num_threads (n);
+#endif
+}
+
+/// @brief get the number of threads in the current parallel section
+unsigned get_thread_count ()
+{
+#ifdef _OPENMP
+    return omp_get_num_threads ();
+#else
+    return 1;
+#endif
+}
+
+/// @brief get the id of this thread in the current parallel section
+unsigned get_thread_id ()
+{
+#ifdef _OPENMP
+    return omp_get_thread_num ();
+#else
+    return 0;
+#endif
+}
+
 }
 
 #endif